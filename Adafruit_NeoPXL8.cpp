@@ -95,12 +95,94 @@ static const int8_t defaultPins[] = NEOPXL8_DEFAULT_PINS;
 static volatile bool sending = 0;     // Set while DMA transfer is active
 static volatile uint32_t lastBitTime; // micros() when last bit issued
 
+// ARENA ALLOCATOR ---------------------------------------------------------
+
+Adafruit_NeoPXL8Arena::Adafruit_NeoPXL8Arena(void *buf, size_t len)
+    : top(0), count(0) {
+  // Round start of arena up to a 32-bit boundary, trim size to match
+  base = (uint8_t *)(((uintptr_t)buf + 3) & ~(uintptr_t)3);
+  size_t skip = base - (uint8_t *)buf;
+  size = (buf && (len > skip)) ? (len - skip) : 0;
+}
+
+void *Adafruit_NeoPXL8Arena::alloc(size_t bytes) {
+  bytes = (bytes + 3) & ~(size_t)3; // Keep next allocation 32-bit aligned
+  if (bytes > (size - top))
+    return NULL;
+  void *ptr = &base[top];
+  top += bytes;
+  count++;
+  return ptr;
+}
+
+void Adafruit_NeoPXL8Arena::release(void *ptr) {
+  // Individual allocations aren't tracked, just counted. Once the last
+  // one is released, the whole arena is available again. NeoPXL8 frees
+  // everything at once in its destructor, so this is sufficient there.
+  if (ptr && count && !--count)
+    top = 0;
+}
+
+void *Adafruit_NeoPXL8Arena::allocHook(size_t bytes, neopxl8_mem_t type,
+                                       void *arg) {
+  return ((Adafruit_NeoPXL8Arena *)arg)->alloc(bytes);
+}
+
+void Adafruit_NeoPXL8Arena::freeHook(void *ptr, neopxl8_mem_t type,
+                                     void *arg) {
+  ((Adafruit_NeoPXL8Arena *)arg)->release(ptr);
+}
+
 // NEOPXL8 CLASS -----------------------------------------------------------
 
-Adafruit_NeoPXL8::Adafruit_NeoPXL8(uint16_t n, int8_t *p, neoPixelType t)
-    : Adafruit_NeoPixel(n * 8, -1, t), brightness(256) {
-  memcpy(pins, p ? p : defaultPins, sizeof(pins));
+Adafruit_NeoPXL8::Adafruit_NeoPXL8(uint16_t n, int8_t *p, neoPixelType t,
+                                   uint8_t lanes)
+    : Adafruit_NeoPixel(n * lanes, -1, t), num_lanes(lanes), brightness(256),
+      timing(neopxl8_timing_800k) {
+  // Default pin list is 8 entries; any lanes beyond that are unused
+  uint8_t count = p ? min(lanes, (uint8_t)NEOPXL8_MAX_LANES) : 8;
+  memset(pins, -1, sizeof(pins));
+  memcpy(pins, p ? p : defaultPins, count);
+}
+
+void *Adafruit_NeoPXL8::mem_alloc(size_t bytes, neopxl8_mem_t type) {
+  if (alloc_func)
+    return alloc_func(bytes, type, alloc_arg);
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  if (type == NEOPXL8_MEM_DMA)
+    return heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+#endif
+  return malloc(bytes);
+}
+
+void Adafruit_NeoPXL8::mem_free(void *ptr, neopxl8_mem_t type) {
+  if (alloc_func) {
+    if (free_func)
+      free_func(ptr, type, alloc_arg);
+    return;
+  }
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  if (type == NEOPXL8_MEM_DMA) {
+    heap_caps_free(ptr);
+    return;
+  }
+#endif
+  free(ptr);
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+void *Adafruit_NeoPXL8::allocPSRAM(size_t bytes, neopxl8_mem_t type,
+                                   void *arg) {
+  if (type == NEOPXL8_MEM_DMA) // GDMA can't reach PSRAM on this path
+    return heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+  void *ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  return ptr ? ptr : heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+}
+
+void Adafruit_NeoPXL8::freePSRAM(void *ptr, neopxl8_mem_t type, void *arg) {
+  heap_caps_free(ptr);
 }
+#endif
 
 // A couple elements of the NeoPXL8 struct must be accessed in the DMA IRQ,
 // which is outside the class. A pointer to the active NeoPXL8 is kept, so
@@ -108,17 +190,25 @@ Adafruit_NeoPXL8::Adafruit_NeoPXL8(uint16_t n, int8_t *p, neoPixelType t)
 // This does mean only a single NeoPXL8 can be active, as on SAMD.
 static Adafruit_NeoPXL8 *neopxl8_ptr = NULL;
 
+// NeoPXL8HDR startRefresh() hooks into the end-of-DMA handling: on ESP32S3
+// its task is notified, on SAMD a function is called from the callback.
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+static TaskHandle_t refresh_handle = NULL;
+#elif !defined(ARDUINO_ARCH_RP2040)
+static void (*refresh_hook)(void) = NULL;
+#endif
+
 #if defined(ARDUINO_ARCH_RP2040)
 // note that ARDUINO_ARCH_RP2040 blocks also apply to RP235x
 
 #define DMA_IRQ_N 1 ///< Can be 0 or 1, no functional difference, 1 looks cool
 
-// PIO code. As currently written, uses 2/9 and 5/9 duty cycle for '0' and
-// '1' bits respectively. This does not match the datasheet, but works well
-// enough (actual NeoPixel output doesn't match the datasheet either,
-// there's ample slop). But if this proves problematic, the delay values
-// can be tweaked and the total cycles can be factored into the value
-// passed to sm_config_set_clkdiv() later.
+// PIO code. As written here, uses 2/9 and 6/9 duty cycle for '0' and '1'
+// bits respectively. This does not exactly match the datasheet, but works
+// well enough (actual NeoPixel output doesn't match the datasheet either,
+// there's ample slop). The delay values shown are for the default 800 KHz
+// timing; begin() substitutes others (and a matching clock divider) if a
+// different neopxl8_timing_t is requested, see Adafruit_NeoPXL8Timing.h.
 static const uint16_t neopxl8_opcodes[] = {
     //             .wrap_target
     0xA103, // 0: mov  pins, null  [1]  Write 8 parallel '0' bits, delay 1
@@ -128,6 +218,11 @@ static const uint16_t neopxl8_opcodes[] = {
             //     .wrap
 };
 
+// Replace the delay field (bits 12-8, no side-set) of a PIO instruction
+static inline uint16_t pio_delay(uint16_t op, uint8_t d) {
+  return (op & ~0x1F00) | (d << 8);
+}
+
 static const struct pio_program neopxl8_program = {
     .instructions = neopxl8_opcodes,
     .length = sizeof neopxl8_opcodes / sizeof neopxl8_opcodes[0],
@@ -163,6 +258,8 @@ static IRAM_ATTR bool dma_callback(gdma_channel_handle_t dma_chan,
   // empirically, not science...may need to increase if last-pixel trouble.
   esp_rom_delay_us(5);
   LCD_CAM.lcd_user.lcd_start = 0;
+  if (refresh_handle)
+    vTaskNotifyGiveFromISR(refresh_handle, NULL);
   // lastBitTime is NOT set in the callback because it would periodically
   // have a 'too early' value. Instead, it's set in the show() function
   // after the lcd_start flag is clear...which shouldn't make a difference,
@@ -172,6 +269,12 @@ static IRAM_ATTR bool dma_callback(gdma_channel_handle_t dma_chan,
   return true;
 }
 
+// Largest payload for one DMA descriptor. Limit is 4095 bytes (sic., NOT
+// 4096), but with the 16-bit bus each descriptor must hold whole words.
+static inline uint32_t desc_bytes(uint8_t lanes) {
+  return (lanes > 8) ? 4094 : 4095;
+}
+
 #else // SAMD
 
 // This table holds PORTs, bits and peripheral selects of valid pattern
@@ -268,35 +371,217 @@ static uint8_t configurePin(int8_t pin) {
 static void dmaCallback(Adafruit_ZeroDMA *dma) {
   lastBitTime = micros();
   sending = 0;
+  if (refresh_hook)
+    refresh_hook();
+}
+
+#ifdef __SAMD51__
+
+// Set up generic clock gen 2 as source for TCC0 (and TCC1, which shares
+// its peripheral channel).
+static void tcc_clock_init(void) {
+  // Datasheet recommends setting GENCTRL register in a single write,
+  // so a temp value is used here to more easily construct a value.
+  GCLK_GENCTRL_Type genctrl;
+  genctrl.bit.SRC = GCLK_GENCTRL_SRC_DFLL_Val; // 48 MHz source
+  genctrl.bit.GENEN = 1;                       // Enable
+  genctrl.bit.OE = 1;
+  genctrl.bit.DIVSEL = 0; // Do not divide clock source
+  genctrl.bit.DIV = 0;
+  GCLK->GENCTRL[2].reg = genctrl.reg;
+  while (GCLK->SYNCBUSY.bit.GENCTRL1 == 1)
+    ;
+
+  GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN = 0;
+  while (GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN)
+    ; // Wait for disable
+  GCLK_PCHCTRL_Type pchctrl;
+  pchctrl.bit.GEN = GCLK_PCHCTRL_GEN_GCLK2_Val;
+  pchctrl.bit.CHEN = 1;
+  GCLK->PCHCTRL[TCC0_GCLK_ID].reg = pchctrl.reg;
+  while (!GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN)
+    ; // Wait for enable
+}
+
+#if defined(NEOPXL8_PORT_DMA)
+
+// PORT DMA output (16 or 32 lanes): each NeoPixel bit is one TCC1 period,
+// in which three compare matches each trigger one DMA write to the PORT
+// group: CC0 sets lanes with a '1' bit (from the DMA buffer), CC1 sets
+// all lanes, CC2 clears all lanes (see neopxl8_port_config()). The buffer
+// thus holds only data, one 16- or 32-bit word per bit. After the last
+// bit, the data channel's second descriptor writes this command on the
+// next CC0, stopping TCC1 before CC1 so no DMA request is left pending;
+// show() restarts the count from zero with all three channels armed.
+static const uint8_t portStopCmd = TCC_CTRLBSET_CMD_STOP;
+
+bool Adafruit_NeoPXL8::port_begin(uint8_t bytesPerPixel) {
+  neopxl8_port_config_t c;
+  uint32_t bits = numLEDs / num_lanes * bytesPerPixel * 8;
+  if (!neopxl8_port_config(&c, 48000000, &timing) || (bits > 65535))
+    return false; // Timing not possible, or too long for one descriptor
+
+  // Port group (and for 16 lanes, which half of it) is set by the first
+  // valid pin. Any others elsewhere are disabled, same as invalid pins
+  // with the pattern generator.
+  int8_t group = -1;
+  uint8_t half = 0; // 16 lanes: 0 = PORT bits 0-15, 1 = bits 16-31
+  port_mask = 0;
+  for (uint8_t i = 0; i < num_lanes; i++) {
+    int8_t pin = pins[i];
+    if ((pin < 0) || (pin >= PINS_COUNT) ||
+        (g_APinDescription[pin].ulPort == NOT_A_PORT))
+      continue;
+    uint8_t g = g_APinDescription[pin].ulPort;
+    uint8_t bit = g_APinDescription[pin].ulPin;
+    if (group < 0) {
+      group = g;
+      if (num_lanes == 16)
+        half = bit / 16;
+    }
+    if ((g != group) || ((num_lanes == 16) && (bit / 16 != half)))
+      continue;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    bitmask[i] = 1UL << ((num_lanes == 16) ? (bit & 15) : bit);
+    port_mask |= bitmask[i];
+  }
+  if (!port_mask)
+    return false;
+
+  uint32_t buf_size = numLEDs * bytesPerPixel + 3; // +3 for long align
+  if (!(allocAddr = (uint8_t *)mem_alloc(buf_size, NEOPXL8_MEM_DMA)))
+    return false;
+  alignedAddr[0] = alignedAddr[1] =
+      (uint32_t *)((uint32_t)(&allocAddr[3]) & ~3);
+  dmaBuf[0] = dmaBuf[1] = (uint8_t *)alignedAddr[0];
+  memset(dmaBuf[0], 0, buf_size - 3);
+
+  // 16 lanes write the lower or upper half of the PORT registers
+  dma_beat_size size =
+      (num_lanes == 16) ? DMA_BEAT_SIZE_HWORD : DMA_BEAT_SIZE_WORD;
+  uint8_t *outset = (uint8_t *)&PORT->Group[group].OUTSET.reg + half * 2;
+  uint8_t *outclr = (uint8_t *)&PORT->Group[group].OUTCLR.reg + half * 2;
+
+  dma.setTrigger(TCC1_DMAC_ID_MC_0);
+  dma.setAction(DMA_TRIGGER_ACTON_BEAT);
+  port_dma[0].setTrigger(TCC1_DMAC_ID_MC_1);
+  port_dma[0].setAction(DMA_TRIGGER_ACTON_BEAT);
+  port_dma[1].setTrigger(TCC1_DMAC_ID_MC_2);
+  port_dma[1].setAction(DMA_TRIGGER_ACTON_BEAT);
+  if ((dma.allocate() != DMA_STATUS_OK) ||
+      (port_dma[0].allocate() != DMA_STATUS_OK) ||
+      (port_dma[1].allocate() != DMA_STATUS_OK)) {
+    mem_free(allocAddr, NEOPXL8_MEM_DMA);
+    allocAddr = NULL;
+    dmaBuf[0] = dmaBuf[1] = NULL;
+    return false;
+  }
+  desc = dma.addDescriptor(dmaBuf[0], outset, bits, size, true, false);
+  dma.addDescriptor((void *)&portStopCmd, (void *)&TCC1->CTRLBSET.reg, 1,
+                    DMA_BEAT_SIZE_BYTE, false, false);
+  dma.setCallback(dmaCallback);
+  port_dma[0].addDescriptor(&port_mask, outset, bits, size, false, false);
+  port_dma[1].addDescriptor(&port_mask, outclr, bits, size, false, false);
+
+  tcc_clock_init();
+  MCLK->APBBMASK.reg |= MCLK_APBBMASK_TCC1;
+
+  TCC1->CTRLA.bit.ENABLE = 0;
+  while (TCC1->SYNCBUSY.bit.ENABLE)
+    ;
+  TCC1->CTRLA.bit.PRESCALER = TCC_CTRLA_PRESCALER_DIV1_Val; // 1:1 Prescale
+  TCC1->WAVE.bit.WAVEGEN = TCC_WAVE_WAVEGEN_NFRQ_Val; // Normal frequency
+  while (TCC1->SYNCBUSY.bit.WAVE)
+    ;
+  TCC1->PER.reg = c.per;
+  while (TCC1->SYNCBUSY.bit.PER)
+    ;
+  // Compare values are past PER (never matched) until TCC1 is enabled and
+  // stopped, else a match in between would leave a DMA request pending.
+  for (uint8_t i = 0; i < 3; i++) {
+    TCC1->CC[i].reg = c.per + 1;
+    while (TCC1->SYNCBUSY.reg & (TCC_SYNCBUSY_CC0 << i))
+      ;
+  }
+  TCC1->CTRLA.bit.ENABLE = 1;
+  while (TCC1->SYNCBUSY.bit.ENABLE)
+    ;
+  TCC1->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+  while (TCC1->SYNCBUSY.bit.CTRLB)
+    ;
+  for (uint8_t i = 0; i < 3; i++) {
+    TCC1->CC[i].reg = c.cc[i];
+    while (TCC1->SYNCBUSY.reg & (TCC_SYNCBUSY_CC0 << i))
+      ;
+  }
+
+  return true;
 }
 
+#endif // end NEOPXL8_PORT_DMA
+
+#endif // end __SAMD51__
+
 #endif // end SAMD
 
 Adafruit_NeoPXL8::~Adafruit_NeoPXL8() {
+  loop_end();
 #if defined(ARDUINO_ARCH_RP2040)
   pio_sm_set_enabled(pio, sm, false);
-  pio_remove_program(pio, &neopxl8_program, offset);
+  pio_remove_program(pio, &neopxl8_program, offset); // Same length as used
   pio_sm_unclaim(pio, sm);
   dma_channel_abort(dma_channel);
   dma_channel_unclaim(dma_channel);
   if (dmaBuf[0])
-    free(dmaBuf[0]);
+    mem_free(dmaBuf[0], NEOPXL8_MEM_DMA);
   irq_remove_handler(DMA_IRQ_N == 0 ? DMA_IRQ_0 : DMA_IRQ_1, dma_finish_irq);
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
   gdma_reset(dma_chan);
   if (allocAddr)
-    heap_caps_free(allocAddr);
+    mem_free(allocAddr, NEOPXL8_MEM_DMA);
 #else
   dma.abort();
+#if defined(NEOPXL8_PORT_DMA)
+  port_dma[0].abort();
+  port_dma[1].abort();
+#endif
   if (allocAddr)
-    free(allocAddr);
+    mem_free(allocAddr, NEOPXL8_MEM_DMA);
 #endif
+  clearLayout();
+  if (pixels_custom) {
+    // Release custom pixel buffer here, and NULL the pointer so the
+    // Adafruit_NeoPixel destructor doesn't try to free() it.
+    mem_free(pixels, NEOPXL8_MEM_PIXELS);
+    pixels = NULL;
+  }
   neopxl8_ptr = NULL;
 }
 
+bool Adafruit_NeoPXL8::begin(const neopxl8_timing_t &t, bool dbuf) {
+  timing = t;
+  return begin(dbuf);
+}
+
 bool Adafruit_NeoPXL8::begin(bool dbuf) {
+  if ((num_lanes != 8) &&
+      ((num_lanes > NEOPXL8_MAX_LANES) || (num_lanes % 16)))
+    return false; // Lane count not supported on this chip
+
   Adafruit_NeoPixel::begin(); // Call base class begin() function 1st
-  if (pixels) {               // Successful malloc of NeoPixel buffer?
+  if (pixels && alloc_func && !pixels_custom) {
+    // Custom allocator is in use. Move NeoPixel buffer, which the
+    // Adafruit_NeoPixel constructor malloc()'d, into custom memory.
+    uint8_t *p = (uint8_t *)mem_alloc(numBytes, NEOPXL8_MEM_PIXELS);
+    if (p) {
+      memset(p, 0, numBytes);
+      pixels_custom = true;
+    }
+    free(pixels);
+    pixels = p;
+  }
+  if (pixels) { // Successful malloc of NeoPixel buffer?
     uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
 
     memset(bitmask, 0, sizeof(bitmask));
@@ -316,10 +601,23 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       return false;
     }
 
+    // PIO program delays and clock divider for requested timing
+    neopxl8_pio_config_t pio_config;
+    if (!neopxl8_pio_config(&pio_config, F_CPU, &timing))
+      return false;
+    uint16_t opcodes[] = {
+        pio_delay(neopxl8_opcodes[0], pio_config.low - 2), // Less 'pull'
+        neopxl8_opcodes[1],
+        pio_delay(neopxl8_opcodes[2], pio_config.high - 1),
+        pio_delay(neopxl8_opcodes[3], pio_config.data - 1),
+    };
+    struct pio_program program = neopxl8_program;
+    program.instructions = opcodes;
+
     uint32_t buf_size = numLEDs * bytesPerPixel;
     uint32_t alloc_size = dbuf ? buf_size * 2 : buf_size;
 
-    if ((dmaBuf[0] = (uint8_t *)malloc(alloc_size))) {
+    if ((dmaBuf[0] = (uint8_t *)mem_alloc(alloc_size, NEOPXL8_MEM_DMA))) {
 
       // If no double buffering, point both to same space
       dmaBuf[1] = dbuf ? &dmaBuf[0][buf_size] : dmaBuf[0];
@@ -329,7 +627,7 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       pio = NULL;
 
       if (!pio_claim_free_sm_and_add_program_for_gpio_range(
-              &neopxl8_program, &pio, &sm, &offset, least_pin, 8, true)) {
+              &program, &pio, &sm, &offset, least_pin, 8, true)) {
         pio = NULL;
         sm = -1;
         offset = 0;
@@ -345,8 +643,7 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       sm_config_set_out_pins(&conf, least_pin, 8);
       sm_config_set_in_shift(&conf, true, false, 8);
       sm_config_set_fifo_join(&conf, PIO_FIFO_JOIN_TX);
-      float div = (float)F_CPU / 800000.0 / 9.0; // 9 = PIO cycles/bit
-      sm_config_set_clkdiv(&conf, div);
+      sm_config_set_clkdiv(&conf, pio_config.div);
       pio_sm_init(pio, sm, offset, &conf);
       pio_sm_set_enabled(pio, sm, true);
 
@@ -394,14 +691,22 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
 
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
 
+    // LCD clock divider for requested bit period (3 PCLKs per bit)
+    uint16_t div_num;
+    uint8_t div_a, div_b;
+    neopxl8_lcd_divider(240000000, timing.period, &div_num, &div_a, &div_b);
+    if ((div_num < 2) || (div_num > 255))
+      return false;
+
     uint32_t xfer_size = numLEDs * bytesPerPixel * 3;
-    uint32_t buf_size = xfer_size + 3;        // +3 for long align
-    int num_desc = (xfer_size + 4094) / 4095; // sic. (NOT 4096)
+    uint32_t buf_size = xfer_size + 3; // +3 for long align
+    uint32_t desc_max = desc_bytes(num_lanes);
+    int num_desc = (xfer_size + desc_max - 1) / desc_max;
+    bool wide = (num_lanes > 8); // 16-bit LCD bus for 16 lanes
     uint32_t alloc_size =
         num_desc * sizeof(dma_descriptor_t) + (dbuf ? buf_size * 2 : buf_size);
 
-    if ((allocAddr = (uint8_t *)heap_caps_malloc(
-             alloc_size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT))) {
+    if ((allocAddr = (uint8_t *)mem_alloc(alloc_size, NEOPXL8_MEM_DMA))) {
 
       // Find first 32-bit aligned address following descriptor list
       alignedAddr[0] =
@@ -431,13 +736,16 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       // Configure LCD clock
       LCD_CAM.lcd_clock.clk_en = 1;             // Enable clock
       LCD_CAM.lcd_clock.lcd_clk_sel = 2;        // PLL240M source
-      LCD_CAM.lcd_clock.lcd_clkm_div_a = 1;     // 1/1 fractional divide,
-      LCD_CAM.lcd_clock.lcd_clkm_div_b = 1;     // plus '99' below yields...
-      LCD_CAM.lcd_clock.lcd_clkm_div_num = 99;  // 1:100 prescale (2.4 MHz CLK)
       LCD_CAM.lcd_clock.lcd_ck_out_edge = 0;    // PCLK low in 1st half cycle
       LCD_CAM.lcd_clock.lcd_ck_idle_edge = 0;   // PCLK low idle
       LCD_CAM.lcd_clock.lcd_clk_equ_sysclk = 1; // PCLK = CLK (ignore CLKCNT_N)
 
+      // Clock divide is div_num + div_b / div_a, e.g. 99 + 1/1 = 1:100
+      // prescale (2.4 MHz CLK) for an 800 KHz bit rate.
+      LCD_CAM.lcd_clock.lcd_clkm_div_a = div_a;
+      LCD_CAM.lcd_clock.lcd_clkm_div_b = div_b;
+      LCD_CAM.lcd_clock.lcd_clkm_div_num = div_num;
+
       // Configure frame format
       LCD_CAM.lcd_ctrl.lcd_rgb_mode_en = 0;    // i8080 mode (not RGB)
       LCD_CAM.lcd_rgb_yuv.lcd_conv_bypass = 0; // Disable RGB/YUV converter
@@ -446,20 +754,23 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       LCD_CAM.lcd_user.lcd_always_out_en = 1;  // Enable 'always out' mode
       LCD_CAM.lcd_user.lcd_8bits_order = 0;    // Do not swap bytes
       LCD_CAM.lcd_user.lcd_bit_order = 0;      // Do not reverse bit order
-      LCD_CAM.lcd_user.lcd_2byte_en = 0;       // 8-bit data mode
+      LCD_CAM.lcd_user.lcd_2byte_en = wide;    // 8- or 16-bit data mode
       LCD_CAM.lcd_user.lcd_dummy = 1;          // Dummy phase(s) @ LCD start
       LCD_CAM.lcd_user.lcd_dummy_cyclelen = 0; // 1 dummy phase
       LCD_CAM.lcd_user.lcd_cmd = 0;            // No command at LCD start
       // Dummy phase(s) MUST be enabled for DMA to trigger reliably.
 
       const uint8_t mux[] = {
-          LCD_DATA_OUT0_IDX, LCD_DATA_OUT1_IDX, LCD_DATA_OUT2_IDX,
-          LCD_DATA_OUT3_IDX, LCD_DATA_OUT4_IDX, LCD_DATA_OUT5_IDX,
-          LCD_DATA_OUT6_IDX, LCD_DATA_OUT7_IDX,
+          LCD_DATA_OUT0_IDX,  LCD_DATA_OUT1_IDX,  LCD_DATA_OUT2_IDX,
+          LCD_DATA_OUT3_IDX,  LCD_DATA_OUT4_IDX,  LCD_DATA_OUT5_IDX,
+          LCD_DATA_OUT6_IDX,  LCD_DATA_OUT7_IDX,  LCD_DATA_OUT8_IDX,
+          LCD_DATA_OUT9_IDX,  LCD_DATA_OUT10_IDX, LCD_DATA_OUT11_IDX,
+          LCD_DATA_OUT12_IDX, LCD_DATA_OUT13_IDX, LCD_DATA_OUT14_IDX,
+          LCD_DATA_OUT15_IDX,
       };
 
       // Route LCD signals to GPIO pins
-      for (int i = 0; i < 8; i++) {
+      for (int i = 0; i < num_lanes; i++) {
         if (pins[i] >= 0) {
           esp_rom_gpio_connect_out_signal(pins[i], mux[i], false, false);
           gpio_hal_iomux_func_sel(GPIO_PIN_MUX_REG[pins[i]], PIN_FUNC_GPIO);
@@ -509,10 +820,21 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
     // on SAMD anyway, mostly an RP2040 thing.
     dbuf = false;
 
+#if defined(NEOPXL8_PORT_DMA)
+    if ((num_lanes > 8) && port_begin(bytesPerPixel))
+      return true; // Success! (PORT DMA, 16 or 32 lanes)
+#endif
+
     uint32_t buf_size = numLEDs * bytesPerPixel * 3 + EXTRASTARTBYTES + 3;
     // uint32_t alloc_size = dbuf ? buf_size * 2 : buf_size;
+#ifdef __SAMD51__
+    uint32_t tcc_clock = 48000000;
+#else
+    uint32_t tcc_clock = F_CPU;
+#endif
 
-    if ((allocAddr = (uint8_t *)malloc(buf_size))) {
+    if ((num_lanes == 8) && neopxl8_tcc_config(tcc_clock, &timing) &&
+        (allocAddr = (uint8_t *)mem_alloc(buf_size, NEOPXL8_MEM_DMA))) {
       int i;
 
       dma.setTrigger(TCC0_DMAC_ID_OVF);
@@ -552,28 +874,7 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       dma.setCallback(dmaCallback);
 
 #ifdef __SAMD51__
-      // Set up generic clock gen 2 as source for TCC0
-      // Datasheet recommends setting GENCTRL register in a single write,
-      // so a temp value is used here to more easily construct a value.
-      GCLK_GENCTRL_Type genctrl;
-      genctrl.bit.SRC = GCLK_GENCTRL_SRC_DFLL_Val; // 48 MHz source
-      genctrl.bit.GENEN = 1;                       // Enable
-      genctrl.bit.OE = 1;
-      genctrl.bit.DIVSEL = 0; // Do not divide clock source
-      genctrl.bit.DIV = 0;
-      GCLK->GENCTRL[2].reg = genctrl.reg;
-      while (GCLK->SYNCBUSY.bit.GENCTRL1 == 1)
-        ;
-
-      GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN = 0;
-      while (GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN)
-        ; // Wait for disable
-      GCLK_PCHCTRL_Type pchctrl;
-      pchctrl.bit.GEN = GCLK_PCHCTRL_GEN_GCLK2_Val;
-      pchctrl.bit.CHEN = 1;
-      GCLK->PCHCTRL[TCC0_GCLK_ID].reg = pchctrl.reg;
-      while (!GCLK->PCHCTRL[TCC0_GCLK_ID].bit.CHEN)
-        ; // Wait for enable
+      tcc_clock_init(); // 48 MHz
 #else
       // Enable GCLK for TCC0
       GCLK->CLKCTRL.reg =
@@ -598,12 +899,8 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
       while (TCC0->SYNCBUSY.bit.CC0)
         ;
 
-        // 2.4 GHz clock: 3 DMA xfers per NeoPixel bit = 800 KHz
-#ifdef __SAMD51__
-      TCC0->PER.reg = ((48000000 + 1200000) / 2400000) - 1;
-#else
-      TCC0->PER.reg = ((F_CPU + 1200000) / 2400000) - 1;
-#endif
+        // 3 DMA xfers per NeoPixel bit, e.g. 2.4 MHz clock = 800 KHz
+      TCC0->PER.reg = neopxl8_tcc_period(tcc_clock, timing.period);
       while (TCC0->SYNCBUSY.bit.PER)
         ;
 
@@ -628,104 +925,246 @@ bool Adafruit_NeoPXL8::begin(bool dbuf) {
 
 #endif // end SAMD
 
-    free(pixels);
+    if (pixels_custom) {
+      mem_free(pixels, NEOPXL8_MEM_PIXELS);
+      pixels_custom = false;
+    } else {
+      free(pixels);
+    }
     pixels = NULL;
   }
 
   return false;
 }
 
+void Adafruit_NeoPXL8::setFrameBuffer(const uint8_t *buf, neoPixelType order,
+                                      uint8_t pixelStride,
+                                      uint32_t strandStride) {
+  // Source offsets of each color component, same encoding as NeoPixel
+  uint8_t sw = (order >> 6) & 3, sr = (order >> 4) & 3, sg = (order >> 2) & 3,
+          sb = order & 3;
+  if (!pixelStride)
+    pixelStride = (sw == sr) ? 3 : 4;
+  if (!strandStride)
+    strandStride = (numLEDs / num_lanes) * pixelStride;
+  // For each byte position in NeoPixel output order, the source byte
+  // within a pixel to read. 0xFF means "no source, issue 0" (W channel
+  // when source is RGB but strands are RGBW).
+  frame_offset[rOffset] = sr;
+  frame_offset[gOffset] = sg;
+  frame_offset[bOffset] = sb;
+  if (wOffset != rOffset)
+    frame_offset[wOffset] = (sw == sr) ? 0xFF : sw;
+  frame_pixel_stride = pixelStride;
+  frame_strand_stride = strandStride;
+  frame_buf = buf;
+}
+
+bool Adafruit_NeoPXL8::setLayout(uint16_t width, uint16_t height,
+                                 uint8_t layout, uint8_t rotation,
+                                 uint8_t tilesAcross, uint8_t tilesDown) {
+  // Map entries are 16-bit source pixel indices, so the image is capped
+  // at 65536 pixels.
+  uint32_t area = (uint32_t)width * height;
+  if ((area < numLEDs) || (area > 65536) || !tilesAcross || !tilesDown ||
+      (width % tilesAcross) || (height % tilesDown))
+    return false;
+
+  uint16_t *map = frame_map;
+  if (!map && !(map = (uint16_t *)mem_alloc(numLEDs * sizeof(uint16_t),
+                                            NEOPXL8_MEM_PIXELS)))
+    return false;
+
+  uint16_t tw = width / tilesAcross, th = height / tilesDown; // Tile size
+  bool vertical = layout & NEOPXL8_LAYOUT_VERTICAL;
+  bool serpentine = layout & NEOPXL8_LAYOUT_SERPENTINE;
+  uint16_t lineLen = vertical ? th : tw; // Pixels per row (or column)
+
+  // For each matrix position, find the source image pixel that lands
+  // there, and the NeoPXL8 pixel index at that position. Table is indexed
+  // by the latter so stage() can walk it in DMA order. If the matrix has
+  // more positions than there are pixels (strand length rounded down),
+  // the extra ones at the end are dropped.
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < width; x++) {
+      uint32_t src;
+      switch (rotation & 3) {
+      case 0:
+        src = (uint32_t)y * width + x;
+        break;
+      case 1: // Source is height wide, width tall
+        src = (uint32_t)(width - 1 - x) * height + y;
+        break;
+      case 2:
+        src = (uint32_t)(height - 1 - y) * width + (width - 1 - x);
+        break;
+      default: // 3
+        src = (uint32_t)x * height + (height - 1 - y);
+        break;
+      }
+      uint16_t lx = x % tw, ly = y % th; // Position within tile
+      uint16_t line = vertical ? lx : ly, pos = vertical ? ly : lx;
+      if (serpentine && (line & 1))
+        pos = lineLen - 1 - pos;
+      uint32_t tile = (uint32_t)(y / th) * tilesAcross + (x / tw);
+      uint32_t i = tile * tw * th + line * lineLen + pos;
+      if (i < numLEDs)
+        map[i] = src;
+    }
+  }
+
+  frame_map = map;
+  return true;
+}
+
+void Adafruit_NeoPXL8::clearLayout(void) {
+  if (frame_map) {
+    uint16_t *map = frame_map;
+    frame_map = NULL;
+    mem_free(map, NEOPXL8_MEM_PIXELS);
+  }
+}
+
+// Set 'mask' bit in DMA buffer for each '1' bit in upper byte of 'value'
+// (brightness-scaled NeoPixel byte), MSB first. On RP2040 each NeoPixel
+// bit is one byte in the DMA buffer, on SAMD & ESP32S3 the data is the
+// middle byte of each high/data/low triplet (stride 3). With 16 or 32
+// lanes, T is uint16_t or uint32_t and each of those is a word rather
+// than a byte; SAMD51 PORT DMA has no triplets (stride 1).
+template <typename T, uint8_t stride>
+static inline void spread_bits(uint16_t value, T *dst, T mask) {
+  // Brightness scaling doesn't require shift down,
+  // we'll just pluck from bits 15-8...
+  if (value & 0x8000)
+    dst[0 * stride] |= mask;
+  if (value & 0x4000)
+    dst[1 * stride] |= mask;
+  if (value & 0x2000)
+    dst[2 * stride] |= mask;
+  if (value & 0x1000)
+    dst[3 * stride] |= mask;
+  if (value & 0x0800)
+    dst[4 * stride] |= mask;
+  if (value & 0x0400)
+    dst[5 * stride] |= mask;
+  if (value & 0x0200)
+    dst[6 * stride] |= mask;
+  if (value & 0x0100)
+    dst[7 * stride] |= mask;
+}
+
 // Convert NeoPixel buffer to NeoPXL8 output format
 void Adafruit_NeoPXL8::stage(void) {
+  stage_to(getStageBuffer());
+  staged = true;
+}
+
+void Adafruit_NeoPXL8::stage_to(uint8_t *buf) {
+#if defined(NEOPXL8_PORT_DMA)
+  if (num_lanes == 32) // PORT DMA, data only
+    stage_lanes<uint32_t, 1>(buf);
+  else if (num_lanes == 16)
+    stage_lanes<uint16_t, 1>(buf);
+  else
+#elif NEOPXL8_MAX_LANES > 8
+  if (num_lanes > 8)
+    stage_lanes<uint16_t, NEOPXL8_DMA_BIT_STRIDE>(buf);
+  else
+#endif
+    stage_lanes<uint8_t, NEOPXL8_DMA_BIT_STRIDE>(buf);
+}
+
+template <typename T, uint8_t stride>
+void Adafruit_NeoPXL8::stage_lanes(uint8_t *buf) {
 
   uint8_t bytesPerLED = (wOffset == rOffset) ? 3 : 4;
-  uint32_t pixelsPerRow = numLEDs / 8, bytesPerRow = pixelsPerRow * bytesPerLED,
-           i;
+  uint32_t pixelsPerRow = numLEDs / num_lanes,
+           bytesPerRow = pixelsPerRow * bytesPerLED, i;
+  T *dst0; // Location of first data bit in DMA buffer
 
 #if defined(ARDUINO_ARCH_RP2040)
 
-  memset(dmaBuf[dbuf_index], 0, numLEDs * bytesPerLED);
-
-  for (uint8_t b = 0; b < 8; b++) { // For each output pin 0-7
-    uint8_t mask = bitmask[b];
-    if (mask) {                                // Enabled?
-      uint8_t *src = &pixels[b * bytesPerRow]; // Start of row data
-      uint8_t *dst = dmaBuf[dbuf_index];
-      for (i = 0; i < bytesPerRow; i++) { // Each byte in row...
-        // Brightness scaling doesn't require shift down,
-        // we'll just pluck from bits 15-8...
-        uint16_t value = *src++ * brightness;
-        if (value & 0x8000)
-          dst[0] |= mask;
-        if (value & 0x4000)
-          dst[1] |= mask;
-        if (value & 0x2000)
-          dst[2] |= mask;
-        if (value & 0x1000)
-          dst[3] |= mask;
-        if (value & 0x0800)
-          dst[4] |= mask;
-        if (value & 0x0400)
-          dst[5] |= mask;
-        if (value & 0x0200)
-          dst[6] |= mask;
-        if (value & 0x0100)
-          dst[7] |= mask;
-        dst += 8;
-      }
-    }
-  }
+  memset(buf, 0, numLEDs * bytesPerLED);
+  dst0 = (T *)buf;
 
 #else // SAMD or ESP32S3
 
-  static const uint8_t dmaFill[] __attribute__((__aligned__(4))) = {
-      0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00,
-      0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00};
-
   // Clear DMA buffer data (32-bit writes are used to save a few cycles)
-  uint32_t *in = (uint32_t *)dmaFill, *out = alignedAddr[dbuf_index];
-  for (i = 0; i < bytesPerRow; i++) {
-    *out++ = in[0];
-    *out++ = in[1];
-    *out++ = in[2];
-    *out++ = in[3];
-    *out++ = in[4];
-    *out++ = in[5];
+  uint32_t *out = (uint32_t *)buf;
+  if (stride == 1) { // SAMD51 PORT DMA, data only
+    memset(out, 0, numLEDs * bytesPerLED);
+  } else if (sizeof(T) == 1) {
+    static const uint8_t dmaFill[] __attribute__((__aligned__(4))) = {
+        0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00,
+        0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00};
+    uint32_t *in = (uint32_t *)dmaFill;
+    for (i = 0; i < bytesPerRow; i++) {
+      *out++ = in[0];
+      *out++ = in[1];
+      *out++ = in[2];
+      *out++ = in[3];
+      *out++ = in[4];
+      *out++ = in[5];
+    }
+  } else {
+    // 16-bit triplets: two of them (12 bytes) per 3 longs, 4X per byte
+    static const uint16_t dmaFill[] __attribute__((__aligned__(4))) = {
+        0xFFFF, 0x0000, 0x0000, 0xFFFF, 0x0000, 0x0000};
+    uint32_t *in = (uint32_t *)dmaFill;
+    for (i = 0; i < bytesPerRow * 4; i++) {
+      *out++ = in[0];
+      *out++ = in[1];
+      *out++ = in[2];
+    }
   }
+  dst0 = &((T *)buf)[stride > 1];
+
+#endif // end SAMD/ESP32S3
 
-  for (uint8_t b = 0; b < 8; b++) { // For each output pin 0-7
-    uint8_t mask = bitmask[b];
-    if (mask) {                                // Enabled?
-      uint8_t *src = &pixels[b * bytesPerRow]; // Start of row data
-      uint8_t *dst = &((uint8_t *)alignedAddr[dbuf_index])[1];
-      for (i = 0; i < bytesPerRow; i++) { // Each byte in row...
-        // Brightness scaling doesn't require shift down,
-        // we'll just pluck from bits 15-8...
-        uint16_t value = *src++ * brightness;
-        if (value & 0x8000)
-          dst[0] |= mask;
-        if (value & 0x4000)
-          dst[3] |= mask;
-        if (value & 0x2000)
-          dst[6] |= mask;
-        if (value & 0x1000)
-          dst[9] |= mask;
-        if (value & 0x0800)
-          dst[12] |= mask;
-        if (value & 0x0400)
-          dst[15] |= mask;
-        if (value & 0x0200)
-          dst[18] |= mask;
-        if (value & 0x0100)
-          dst[21] |= mask;
-        dst += 24;
+  for (uint8_t b = 0; b < num_lanes; b++) { // For each output pin
+    T mask = bitmask[b];
+    if (mask) { // Enabled?
+      T *dst = dst0;
+      if (frame_buf) { // Staging from external framebuffer
+        const uint8_t *src = &frame_buf[b * frame_strand_stride];
+        const uint16_t *map = frame_map ? &frame_map[b * pixelsPerRow] : NULL;
+        for (i = 0; i < pixelsPerRow; i++) { // Each pixel in row...
+          if (map) // Layout table provides source pixel
+            src = &frame_buf[*map++ * frame_pixel_stride];
+          for (uint8_t c = 0; c < bytesPerLED; c++) { // Each byte of pixel...
+            uint8_t o = frame_offset[c];
+            if (o != 0xFF) // No source byte = 0, nothing to set
+              spread_bits<T, stride>(src[o] * brightness, dst, mask);
+            dst += 8 * stride;
+          }
+          src += frame_pixel_stride;
+        }
+      } else {                                   // NeoPixel buffer
+        uint8_t *src = &pixels[b * bytesPerRow]; // Start of row data
+        for (i = 0; i < bytesPerRow; i++) {      // Each byte in row...
+          spread_bits<T, stride>(*src++ * brightness, dst, mask);
+          dst += 8 * stride;
+        }
       }
     }
   }
+}
 
-#endif // end SAMD/ESP32S3
+uint8_t *Adafruit_NeoPXL8::getStageBuffer(void) const {
+#if defined(ARDUINO_ARCH_RP2040)
+  return dmaBuf[dbuf_index];
+#else
+  return dmaBuf[dbuf_index] ? (uint8_t *)alignedAddr[dbuf_index] : NULL;
+#endif
+}
 
-  staged = true;
+uint32_t Adafruit_NeoPXL8::getStageBufferSize(void) const {
+  uint32_t size = numLEDs * ((wOffset == rOffset) ? 3 : 4);
+#if defined(NEOPXL8_PORT_DMA)
+  if (num_lanes > 8)
+    return size; // PORT DMA, data only
+#endif
+  return size * NEOPXL8_DMA_BIT_STRIDE;
 }
 
 void Adafruit_NeoPXL8::show(void) {
@@ -787,14 +1226,15 @@ void Adafruit_NeoPXL8::show(void) {
 
   uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
   uint32_t xfer_size = numLEDs * bytesPerPixel * 3;
-  int num_desc = (xfer_size + 4094) / 4095; // sic. (NOT 4096)
+  int desc_max = desc_bytes(num_lanes);
+  int num_desc = (xfer_size + desc_max - 1) / desc_max;
 
   int bytesToGo = xfer_size;
   int offset = 0;
   for (int i = 0; i < num_desc; i++) {
     int bytesThisPass = bytesToGo;
-    if (bytesThisPass > 4095)
-      bytesThisPass = 4095;
+    if (bytesThisPass > desc_max)
+      bytesThisPass = desc_max;
     desc[i].dw0.size = desc[i].dw0.length = bytesThisPass;
     desc[i].buffer = &dmaBuf[dbuf_index][offset];
     bytesToGo -= bytesThisPass;
@@ -810,6 +1250,21 @@ void Adafruit_NeoPXL8::show(void) {
 
 #else // SAMD
 
+#if defined(NEOPXL8_PORT_DMA)
+  if (num_lanes > 8) {
+    // PORT DMA: TCC1 stopped after the last transfer. Arm all three
+    // channels, then restart the count from zero so their compare
+    // matches come in order.
+    dma.startJob();
+    port_dma[0].startJob();
+    port_dma[1].startJob();
+    while ((micros() - lastBitTime) <= latchtime) // Wait for latch
+      ;
+    TCC1->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER; // Start new transfer
+    return; // Single-buffered, no index swap
+  }
+#endif
+
   // Reset DMA source address for next transfer
   dma.changeDescriptor(desc, dmaBuf[dbuf_index], NULL, 0);
 
@@ -846,30 +1301,486 @@ bool Adafruit_NeoPXL8::canShow(void) const {
   return !sending && ((micros() - lastBitTime) > latchtime);
 }
 
+// DMA LOOP ----------------------------------------------------------------
+
+// A fixed series of frames (e.g. every step of NeoPXL8HDR's dither cycle,
+// precomputed) can be issued over and over by DMA alone. Each frame is
+// followed by a latch gap, and the last frame leads back to the first:
+// - RP2040: the data channel chains to a 'gap' channel, which moves one
+//   dummy word per microsecond, paced by a DMA timer, while the PIO state
+//   machine idles low waiting on its FIFO. That chains to a 'control'
+//   channel, which copies the next frame's address (from a ring-aligned
+//   list) into the data channel's read-address-and-trigger register.
+// - ESP32S3 and SAMD: a circular list of descriptors alternates between
+//   frames and a shared run of zeros (output low) for the latch gap.
+// Frame 0 is the existing stage buffer; others are allocated here.
+
+#if defined(ARDUINO_ARCH_RP2040)
+static uint32_t loop_dummy; // Latch gap channel source & destination
+#endif
+
+bool Adafruit_NeoPXL8::loop_begin(uint16_t frames) {
+  if (!dmaBuf[0] || !frames || (frames > 256) || (frames & (frames - 1)))
+    return false;
+  uint32_t frame_bytes = getStageBufferSize();
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+  // Control channel read ring wraps on its own (power-of-2) size, so the
+  // frame address list must be aligned to that; 2X space covers it.
+  uint32_t list_bytes = frames * sizeof(uint32_t);
+  uint8_t ring_bits = 2;
+  while ((1UL << ring_bits) < list_bytes)
+    ring_bits++;
+  if (!(loop_alloc = (uint8_t *)mem_alloc(
+            list_bytes * 2 + (frames - 1) * frame_bytes, NEOPXL8_MEM_DMA)))
+    return false;
+  uint32_t *list = (uint32_t *)(((uintptr_t)loop_alloc + list_bytes - 1) &
+                                ~(uintptr_t)(list_bytes - 1));
+  loop_buf = &loop_alloc[list_bytes * 2];
+  loop_stride = frame_bytes;
+  loop_frames = frames;
+  for (uint16_t i = 0; i < frames; i++)
+    list[i] = (uintptr_t)loop_frame(i);
+
+  loop_dma[0] = dma_claim_unused_channel(false);
+  loop_dma[1] = dma_claim_unused_channel(false);
+  loop_timer = dma_claim_unused_timer(false);
+  if ((loop_dma[0] < 0) || (loop_dma[1] < 0) || (loop_timer < 0)) {
+    loop_end();
+    return false;
+  }
+
+  // Latch gap: one transfer per microsecond, plus a few to let the PIO
+  // FIFO drain before the count starts to matter.
+  dma_timer_set_fraction(loop_timer, 1, F_CPU / 1000000);
+  dma_channel_config c = dma_channel_get_default_config(loop_dma[0]);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, dma_get_timer_dreq(loop_timer));
+  channel_config_set_chain_to(&c, loop_dma[1]);
+  dma_channel_configure(loop_dma[0], &c, &loop_dummy, &loop_dummy,
+                        latchtime + 10, false);
+
+  // Control: next frame address to data channel, which starts it
+  c = dma_channel_get_default_config(loop_dma[1]);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_ring(&c, false, ring_bits);
+  dma_channel_configure(loop_dma[1], &c,
+                        &dma_channel_hw_addr(dma_channel)->al3_read_addr_trig,
+                        list, 1, false);
+
+  // Data: whole frame per trigger, then latch gap. No end-of-DMA IRQ.
+  channel_config_set_chain_to(&dma_config, loop_dma[0]);
+  dma_channel_set_config(dma_channel, &dma_config, false);
+  dma_channel_set_trans_count(dma_channel, frame_bytes, false);
+#if (DMA_IRQ_N == 0)
+  dma_channel_set_irq0_enabled(dma_channel, false);
+#else
+  dma_channel_set_irq1_enabled(dma_channel, false);
+#endif
+
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+
+  // Latch gap in LCD clocks (3 per bit) and bytes, split into as many
+  // descriptors as needed, all pointing to the same run of zeros
+  uint8_t word_size = num_lanes / 8;
+  uint32_t desc_max = desc_bytes(num_lanes);
+  uint32_t gap_bytes =
+      (latchtime * 3000 + timing.period - 1) / timing.period * word_size;
+  uint32_t zero_bytes = (gap_bytes < desc_max) ? gap_bytes : desc_max;
+  int frame_desc = (frame_bytes + desc_max - 1) / desc_max;
+  int gap_desc = (gap_bytes + desc_max - 1) / desc_max;
+  int num_desc = frames * (frame_desc + gap_desc);
+  uint32_t desc_size = num_desc * sizeof(dma_descriptor_t);
+  loop_stride = (frame_bytes + 3) & ~3;
+  if (!(loop_alloc = (uint8_t *)mem_alloc(desc_size + ((zero_bytes + 3) & ~3) +
+                                              (frames - 1) * loop_stride + 3,
+                                          NEOPXL8_MEM_DMA)))
+    return false;
+  loop_desc = (dma_descriptor_t *)(((uint32_t)loop_alloc + 3) & ~3);
+  uint8_t *zeros = &((uint8_t *)loop_desc)[desc_size];
+  memset(zeros, 0, zero_bytes);
+  loop_buf = &zeros[(zero_bytes + 3) & ~3];
+  loop_frames = frames;
+
+  dma_descriptor_t *d = loop_desc;
+  for (uint16_t f = 0; f < frames; f++) {
+    uint8_t *buf = loop_frame(f);
+    for (uint32_t offset = 0; offset < frame_bytes; offset += desc_max, d++) {
+      uint32_t len = frame_bytes - offset;
+      d->dw0.size = d->dw0.length = (len > desc_max) ? desc_max : len;
+      d->buffer = &buf[offset];
+    }
+    for (uint32_t offset = 0; offset < gap_bytes; offset += desc_max, d++) {
+      uint32_t len = gap_bytes - offset;
+      d->dw0.size = d->dw0.length = (len > desc_max) ? desc_max : len;
+      d->buffer = zeros;
+    }
+  }
+  for (int i = 0; i < num_desc; i++) {
+    loop_desc[i].dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+    loop_desc[i].dw0.suc_eof = 0; // Never 'done', no callback
+    loop_desc[i].next = &loop_desc[(i + 1) % num_desc];
+  }
+
+#else // SAMD
+
+#if defined(NEOPXL8_PORT_DMA)
+  if (num_lanes > 8)
+    return false; // PORT DMA 'zeros' aren't low, and TCC1 stops each frame
+#endif
+  uint32_t gap_bytes = (latchtime * 3000 + timing.period - 1) / timing.period;
+  if ((frame_bytes > 65535) || (gap_bytes > 65535))
+    return false; // Too long for a single descriptor's beat count
+  loop_stride = (frame_bytes + 3) & ~3;
+  uint32_t zero_size = (gap_bytes + 3) & ~3;
+  if (!(loop_alloc = (uint8_t *)mem_alloc(
+            zero_size + (frames - 1) * loop_stride + 3, NEOPXL8_MEM_DMA)))
+    return false;
+  uint8_t *zeros = (uint8_t *)(((uint32_t)loop_alloc + 3) & ~3);
+  memset(zeros, 0, gap_bytes);
+  loop_buf = &zeros[zero_size];
+  loop_frames = frames;
+
+  // First descriptor (from begin()) becomes frame 0, others are appended.
+  // EXTRASTARTBYTES aren't needed; transfer never stops after the first.
+  // Adafruit_ZeroDMA has no call to remove descriptors, so loop_end()
+  // just unlinks these, and they can't be reused by a later loop_begin().
+  uint8_t *dst = &((uint8_t *)(&TCC0->PATT))[1]; // PAT.vec.PGV
+  dma.changeDescriptor(desc, loop_frame(0), NULL, frame_bytes);
+  for (uint16_t f = 0; f < frames; f++) {
+    if ((f && !dma.addDescriptor(loop_frame(f), dst, frame_bytes,
+                                 DMA_BEAT_SIZE_BYTE, true, false)) ||
+        !dma.addDescriptor(zeros, dst, gap_bytes, DMA_BEAT_SIZE_BYTE, true,
+                           false)) {
+      loop_end();
+      return false;
+    }
+  }
+  dma.loop(true);
+
+#endif
+
+  return true;
+}
+
+void Adafruit_NeoPXL8::loop_start(void) {
+  if (!loop_frames || looping)
+    return;
+#if defined(ARDUINO_ARCH_RP2040)
+  while (sending) // Any prior show() must finish first
+    ;
+  pio_sm_clear_fifos(pio, sm);
+  while ((micros() - lastBitTime) <= latchtime) // Wait for latch
+    ;
+  dma_channel_start(loop_dma[1]); // Control channel loads frame 0 address
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+  while (LCD_CAM.lcd_user.lcd_start)
+    ;
+  gdma_reset(dma_chan);
+  LCD_CAM.lcd_user.lcd_dout = 1;
+  LCD_CAM.lcd_user.lcd_update = 1;
+  LCD_CAM.lcd_misc.lcd_afifo_reset = 1;
+  esp_rom_delay_us(latchtime);
+  gdma_start(dma_chan, (intptr_t)&loop_desc[0]);
+  esp_rom_delay_us(1);
+  LCD_CAM.lcd_user.lcd_start = 1;
+#else // SAMD
+  while (sending)
+    ;
+  dma.startJob();
+  while ((micros() - lastBitTime) <= latchtime) // Wait for latch
+    ;
+  dma.trigger();
+#endif
+  looping = true;
+}
+
+void Adafruit_NeoPXL8::loop_stop(void) {
+  if (!looping)
+    return;
+#if defined(ARDUINO_ARCH_RP2040)
+  // Break the chain first, so an abort doesn't set off the next channel
+  channel_config_set_chain_to(&dma_config, dma_channel);
+  dma_channel_set_config(dma_channel, &dma_config, false);
+  dma_channel_abort(loop_dma[0]);
+  dma_channel_abort(loop_dma[1]);
+  dma_channel_abort(dma_channel);
+  channel_config_set_chain_to(&dma_config, loop_dma[0]); // For loop_start()
+  dma_channel_set_config(dma_channel, &dma_config, false);
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+  LCD_CAM.lcd_user.lcd_start = 0;
+  gdma_stop(dma_chan);
+#else // SAMD
+  dma.abort();
+  ((uint8_t *)(&TCC0->PATT))[1] = 0; // May have stopped mid-bit, go low
+#endif
+  lastBitTime = micros(); // loop_start() waits for latch from here
+  looping = false;
+}
+
+void Adafruit_NeoPXL8::loop_end(void) {
+  loop_stop();
+  // Put the output DMA back as begin() left it, for normal show()
+#if defined(ARDUINO_ARCH_RP2040)
+  if (loop_dma[0] >= 0) {
+    channel_config_set_chain_to(&dma_config, dma_channel);
+    dma_channel_set_config(dma_channel, &dma_config, false);
+#if (DMA_IRQ_N == 0)
+    dma_channel_set_irq0_enabled(dma_channel, true);
+#else
+    dma_channel_set_irq1_enabled(dma_channel, true);
+#endif
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    if (loop_dma[i] >= 0) {
+      dma_channel_unclaim(loop_dma[i]);
+      loop_dma[i] = -1;
+    }
+  }
+  if (loop_timer >= 0) {
+    dma_timer_unclaim(loop_timer);
+    loop_timer = -1;
+  }
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+  loop_desc = NULL; // Separate from show()'s descriptors, nothing to undo
+#else // SAMD
+  if (loop_alloc) {
+    // Unlink the loop's descriptors (Adafruit_ZeroDMA can't release them,
+    // see loop_begin() note) and restore the EXTRASTARTBYTES lead-in.
+    dma.loop(false);
+    desc->DESCADDR.reg = 0;
+    dma.changeDescriptor(desc, dmaBuf[dbuf_index], NULL,
+                         getStageBufferSize() + EXTRASTARTBYTES);
+  }
+#endif
+  if (loop_alloc)
+    mem_free(loop_alloc, NEOPXL8_MEM_DMA);
+  loop_alloc = loop_buf = NULL;
+  loop_frames = 0;
+}
+
 // NEOPXL8HDR CLASS --------------------------------------------------------
 
-Adafruit_NeoPXL8HDR::Adafruit_NeoPXL8HDR(uint16_t n, int8_t *p, neoPixelType t)
-    : Adafruit_NeoPXL8(n, p, t) {}
+// 4x4 Bayer matrix, for spatial dither phase (row = strand, column = pixel
+// along strand, both mod 4). Adjacent positions are far apart in value.
+static const uint8_t bayer4x4[] = {0, 8,  2,  10, 12, 4, 14, 6,
+                                   3, 11, 1,  9,  15, 7, 13, 5};
+
+// Settings that refresh() reads all through a frame (gamma table, color
+// matrix, brightness scales) are kept in three copies: the current one, one
+// the frame in progress (on another core, or in the refresh engine's
+// interrupt) may still be holding, and a spare. A change is written to the
+// spare and then made current, so a frame never sees a half-written copy,
+// however quickly changes follow one another. Assumes changes come from a
+// single thread.
+static uint8_t spare_copy(uint8_t current, uint8_t held) {
+  uint8_t i = 0;
+  while ((i == current) || (i == held))
+    i++;
+  return i;
+}
+
+// Frame start: note the current copy as held, and return it. Re-checked
+// in case it was swapped at the same moment, so a change made after this
+// always sees which copy the frame is using.
+static uint8_t hold_copy(volatile uint8_t &current, volatile uint8_t &held) {
+  uint8_t i;
+  do {
+    held = i = current;
+  } while (i != current);
+  return i;
+}
+
+// Prebuilt gamma tables for common gamma values, exactly as
+// calc_gamma_table() would compute them (i + pow(i / 255, gamma) *
+// (0xFF00 - i), rounded), so begin() and setBrightness() with these values
+// skip the 256 pow() calls, which are slow on FPU-less SAMD21.
+static const uint16_t gamma22[] = {0,     1,     4,     7,     11,    16,
+                                   23,    31,    40,    51,    63,    76,
+                                   90,    107,   124,   143,   164,   186,
+                                   209,   235,   261,   290,   320,   351,
+                                   384,   419,   456,   494,   534,   575,
+                                   619,   664,   710,   759,   809,   861,
+                                   915,   971,   1028,  1087,  1148,  1211,
+                                   1276,  1342,  1411,  1481,  1553,  1627,
+                                   1703,  1781,  1860,  1942,  2026,  2111,
+                                   2198,  2288,  2379,  2472,  2567,  2664,
+                                   2763,  2865,  2968,  3073,  3180,  3289,
+                                   3400,  3513,  3628,  3745,  3864,  3986,
+                                   4109,  4234,  4362,  4491,  4622,  4756,
+                                   4892,  5029,  5169,  5311,  5455,  5601,
+                                   5750,  5900,  6052,  6207,  6364,  6523,
+                                   6684,  6847,  7012,  7180,  7349,  7521,
+                                   7695,  7871,  8049,  8230,  8412,  8597,
+                                   8784,  8973,  9165,  9359,  9554,  9752,
+                                   9953,  10155, 10360, 10567, 10776, 10988,
+                                   11201, 11417, 11635, 11856, 12078, 12303,
+                                   12531, 12760, 12992, 13226, 13462, 13701,
+                                   13942, 14185, 14430, 14678, 14928, 15180,
+                                   15435, 15692, 15951, 16213, 16477, 16743,
+                                   17012, 17282, 17556, 17831, 18109, 18389,
+                                   18672, 18957, 19244, 19534, 19826, 20120,
+                                   20417, 20716, 21018, 21322, 21628, 21937,
+                                   22248, 22561, 22877, 23195, 23516, 23839,
+                                   24164, 24492, 24822, 25154, 25490, 25827,
+                                   26167, 26509, 26854, 27201, 27550, 27902,
+                                   28257, 28614, 28973, 29335, 29699, 30066,
+                                   30435, 30806, 31180, 31557, 31936, 32317,
+                                   32701, 33087, 33476, 33867, 34261, 34657,
+                                   35056, 35457, 35861, 36267, 36676, 37087,
+                                   37500, 37916, 38335, 38756, 39180, 39606,
+                                   40035, 40466, 40900, 41336, 41775, 42216,
+                                   42660, 43106, 43555, 44006, 44460, 44917,
+                                   45376, 45837, 46301, 46768, 47237, 47709,
+                                   48183, 48660, 49139, 49621, 50106, 50593,
+                                   51082, 51575, 52069, 52567, 53067, 53569,
+                                   54074, 54582, 55092, 55605, 56120, 56638,
+                                   57159, 57682, 58208, 58736, 59267, 59801,
+                                   60337, 60876, 61417, 61961, 62508, 63057,
+                                   63609, 64163, 64720, 65280};
+static const uint16_t gamma26[] = {0,     1,     2,     4,     5,     7,
+                                   10,    13,    16,    20,    24,    29,
+                                   35,    41,    48,    56,    65,    74,
+                                   84,    95,    107,   120,   134,   148,
+                                   164,   181,   198,   217,   237,   258,
+                                   280,   303,   328,   353,   380,   408,
+                                   438,   468,   500,   534,   568,   604,
+                                   642,   681,   721,   763,   806,   850,
+                                   897,   944,   994,   1044,  1097,  1151,
+                                   1206,  1264,  1323,  1383,  1446,  1510,
+                                   1576,  1643,  1712,  1783,  1856,  1931,
+                                   2008,  2086,  2166,  2248,  2332,  2418,
+                                   2506,  2596,  2688,  2782,  2877,  2975,
+                                   3075,  3177,  3281,  3387,  3495,  3605,
+                                   3718,  3832,  3949,  4068,  4189,  4312,
+                                   4437,  4565,  4695,  4827,  4961,  5098,
+                                   5237,  5378,  5522,  5668,  5816,  5967,
+                                   6120,  6276,  6434,  6594,  6757,  6922,
+                                   7090,  7260,  7433,  7608,  7786,  7966,
+                                   8149,  8334,  8522,  8713,  8906,  9102,
+                                   9300,  9501,  9705,  9911,  10120, 10332,
+                                   10547, 10764, 10984, 11207, 11432, 11660,
+                                   11892, 12125, 12362, 12601, 12844, 13089,
+                                   13337, 13588, 13842, 14098, 14358, 14621,
+                                   14886, 15155, 15426, 15700, 15978, 16258,
+                                   16541, 16828, 17117, 17410, 17705, 18004,
+                                   18305, 18610, 18918, 19229, 19543, 19860,
+                                   20181, 20504, 20831, 21161, 21494, 21830,
+                                   22170, 22513, 22859, 23208, 23561, 23916,
+                                   24276, 24638, 25004, 25373, 25745, 26121,
+                                   26500, 26882, 27268, 27657, 28050, 28446,
+                                   28846, 29248, 29655, 30065, 30478, 30895,
+                                   31315, 31739, 32166, 32597, 33031, 33469,
+                                   33910, 34355, 34804, 35256, 35711, 36171,
+                                   36634, 37100, 37570, 38044, 38522, 39003,
+                                   39488, 39976, 40469, 40964, 41464, 41968,
+                                   42475, 42986, 43500, 44019, 44541, 45067,
+                                   45597, 46130, 46668, 47209, 47754, 48303,
+                                   48856, 49413, 49973, 50538, 51106, 51679,
+                                   52255, 52835, 53419, 54007, 54599, 55195,
+                                   55795, 56399, 57007, 57619, 58235, 58855,
+                                   59479, 60108, 60740, 61376, 62017, 62661,
+                                   63310, 63962, 64619, 65280};
+static const uint16_t gamma28[] = {0,     1,     2,     3,     5,     6,
+                                   8,     10,    12,    15,    18,    21,
+                                   25,    29,    33,    38,    44,    50,
+                                   57,    64,    72,    81,    90,    100,
+                                   111,   123,   135,   148,   162,   177,
+                                   193,   210,   227,   246,   265,   286,
+                                   308,   330,   354,   379,   405,   432,
+                                   460,   490,   520,   552,   585,   620,
+                                   656,   693,   731,   771,   812,   855,
+                                   899,   944,   991,   1040,  1090,  1142,
+                                   1195,  1249,  1306,  1364,  1423,  1485,
+                                   1548,  1612,  1679,  1747,  1817,  1889,
+                                   1962,  2038,  2115,  2194,  2275,  2358,
+                                   2443,  2530,  2619,  2709,  2802,  2897,
+                                   2994,  3093,  3194,  3297,  3403,  3510,
+                                   3620,  3732,  3846,  3962,  4081,  4201,
+                                   4325,  4450,  4578,  4708,  4840,  4975,
+                                   5112,  5252,  5394,  5539,  5686,  5835,
+                                   5987,  6142,  6299,  6459,  6621,  6786,
+                                   6954,  7124,  7297,  7472,  7651,  7832,
+                                   8015,  8202,  8391,  8583,  8778,  8976,
+                                   9176,  9380,  9586,  9795,  10007, 10222,
+                                   10441, 10662, 10885, 11112, 11343, 11576,
+                                   11812, 12051, 12293, 12539, 12787, 13039,
+                                   13294, 13552, 13813, 14078, 14346, 14617,
+                                   14891, 15168, 15449, 15734, 16021, 16312,
+                                   16606, 16904, 17205, 17510, 17818, 18129,
+                                   18444, 18763, 19085, 19410, 19739, 20072,
+                                   20408, 20748, 21091, 21439, 21789, 22144,
+                                   22502, 22864, 23229, 23598, 23971, 24348,
+                                   24729, 25113, 25501, 25894, 26289, 26689,
+                                   27093, 27501, 27912, 28328, 28747, 29170,
+                                   29598, 30029, 30465, 30904, 31347, 31795,
+                                   32247, 32703, 33162, 33626, 34095, 34567,
+                                   35044, 35524, 36009, 36499, 36992, 37490,
+                                   37992, 38498, 39009, 39524, 40043, 40567,
+                                   41095, 41627, 42164, 42706, 43251, 43802,
+                                   44356, 44916, 45479, 46048, 46620, 47198,
+                                   47780, 48366, 48957, 49553, 50154, 50759,
+                                   51368, 51983, 52602, 53226, 53854, 54488,
+                                   55126, 55769, 56416, 57069, 57726, 58388,
+                                   59055, 59727, 60404, 61086, 61772, 62464,
+                                   63161, 63862, 64569, 65280};
+
+static const struct {
+  float gamma;           ///< Gamma value, compared exactly
+  const uint16_t *table; ///< 256 gamma table entries
+} gamma_builtin[] = {{2.2, gamma22}, {2.6, gamma26}, {2.8, gamma28}};
+
+Adafruit_NeoPXL8HDR::Adafruit_NeoPXL8HDR(uint16_t n, int8_t *p, neoPixelType t,
+                                         uint8_t lanes)
+    : Adafruit_NeoPXL8(n, p, t, lanes), dither_mode(NEOPXL8_DITHER_ORDERED) {}
 
 Adafruit_NeoPXL8HDR::~Adafruit_NeoPXL8HDR() {
+  stopRefresh();
+  if (residual)
+    mem_free(residual, NEOPXL8_MEM_PIXELS);
   if (dither_table)
-    free(dither_table);
+    mem_free(dither_table, NEOPXL8_MEM_PIXELS);
   if (pixel_buf[0])
-    free(pixel_buf[0]);
+    mem_free(pixel_buf[0], NEOPXL8_MEM_PIXELS);
 }
 
-bool Adafruit_NeoPXL8HDR::begin(bool blend, uint8_t bits, bool dbuf) {
+bool Adafruit_NeoPXL8HDR::begin(const neopxl8_timing_t &t, bool blend,
+                                uint8_t bits, bool dbuf, uint16_t brightness,
+                                float y) {
+  timing = t;
+  return begin(blend, bits, dbuf, brightness, y);
+}
+
+bool Adafruit_NeoPXL8HDR::begin(bool blend, uint8_t bits, bool dbuf,
+                                uint16_t brightness, float y) {
   // If blend flag is set, allocate 3X pixel buffers, else 2X (for
   // temporal dithering only). Result is the buffer size in 16-bit
   // words (not bytes).
+  if (dither_loop) // No blending or 2nd DMA buffer with precomputed frames
+    blend = dbuf = false;
   uint32_t buf_size = numBytes * (blend ? 3 : 2);
 
   dither_bits = (bits > 8) ? 8 : bits;
-
-  if ((pixel_buf[0] = (uint16_t *)malloc(buf_size * sizeof(uint16_t)))) {
-    if ((dither_table =
-             (uint16_t *)malloc((1 << dither_bits) * sizeof(uint16_t)))) {
-      if (Adafruit_NeoPXL8::begin(dbuf)) {
+  dither_active =
+      (flicker_hz && !dither_loop && (dither_min < dither_bits)) ? dither_min
+                                                                 : dither_bits;
+  dither_index = 0;
+
+  if ((pixel_buf[0] = (uint16_t *)mem_alloc(buf_size * sizeof(uint16_t),
+                                             NEOPXL8_MEM_PIXELS))) {
+    if ((dither_table = (uint16_t *)mem_alloc(
+             (1 << dither_bits) * sizeof(uint16_t), NEOPXL8_MEM_PIXELS))) {
+      // Sigma-delta residuals, one byte per channel, if that's selected
+      if (dither_mode == NEOPXL8_DITHER_SIGMA_DELTA)
+        residual = (uint8_t *)mem_alloc(numBytes, NEOPXL8_MEM_PIXELS);
+      if (((dither_mode != NEOPXL8_DITHER_SIGMA_DELTA) || residual) &&
+          Adafruit_NeoPXL8::begin(dbuf) &&
+          (!dither_loop || loop_begin(1 << dither_bits))) {
 #if defined(ARDUINO_ARCH_RP2040)
         mutex_init(&mutex);
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
@@ -885,8 +1796,16 @@ bool Adafruit_NeoPXL8HDR::begin(bool blend, uint8_t bits, bool dbuf) {
           }
           dither_table[i] = result << (16 - dither_bits);
         }
-        setBrightness(65535, 1.0); // Sets up gamma LUT (max bright, linear)
+        setBrightness(brightness, y); // Sets up gamma LUT
         memset(pixel_buf[0], 0, buf_size * sizeof(uint16_t));
+        if (residual) { // Stagger sigma-delta start, as spatial dither
+          uint8_t bpp = (wOffset == rOffset) ? 3 : 4;
+          uint32_t strand_pixels = numLEDs / num_lanes;
+          for (uint32_t i = 0; i < numBytes; i++) {
+            uint32_t n = i / bpp, x = n % strand_pixels, y = n / strand_pixels;
+            residual[i] = (bayer4x4[((y & 3) << 2) | (x & 3)] << 4) | 8;
+          }
+        }
         if (blend) {
           // 3 pixel buffers (2 for blending & dithering, plus original)
           pixel_buf[1] = &pixel_buf[0][numBytes];
@@ -905,16 +1824,54 @@ bool Adafruit_NeoPXL8HDR::begin(bool blend, uint8_t bits, bool dbuf) {
         pixel_buf[2] = &pixel_buf[1][numBytes];
         return true; // Good to go!
       }
-      // If NeoPXL8::begin() failed, free any interim allocations.
-      free(dither_table);
+      // If NeoPXL8::begin() (or loop) failed, free interim allocations.
+      // Anything NeoPXL8::begin() allocated is released in destructor.
+      if (residual) {
+        mem_free(residual, NEOPXL8_MEM_PIXELS);
+        residual = NULL;
+      }
+      mem_free(dither_table, NEOPXL8_MEM_PIXELS);
       dither_table = NULL;
     }
-    free(pixel_buf[0]);
+    mem_free(pixel_buf[0], NEOPXL8_MEM_PIXELS);
     pixel_buf[0] = NULL;
   }
   return false;
 }
 
+void Adafruit_NeoPXL8HDR::setAdaptiveDither(uint8_t minBits, uint16_t hz) {
+  dither_min = (minBits > 8) ? 8 : minBits;
+  flicker_hz = hz;
+  // Adaptive depth changes at the end of each dither cycle in refresh(),
+  // but going back to fixed depth can happen right away.
+  if (!hz)
+    dither_active = dither_bits;
+  settings_changed = true;
+  refresh_kick();
+}
+
+void Adafruit_NeoPXL8HDR::setColorMatrix(const float *m) {
+  if (m) { // Fill a copy refresh() isn't using, then switch to it
+    uint8_t n = spare_copy(matrix_index, matrix_held);
+    for (uint8_t i = 0; i < 9; i++) {
+      float f = (m[i] < -2.0) ? -2.0 : (m[i] > 2.0) ? 2.0 : m[i];
+      color_matrix[n][i] = (int16_t)(f * 4096.0 + ((f < 0) ? -0.5 : 0.5));
+    }
+    matrix_index = n;
+    matrix_on = true;
+  } else {
+    matrix_on = false;
+  }
+  settings_changed = true;
+  refresh_kick();
+}
+
+void Adafruit_NeoPXL8HDR::setWhiteExtraction(uint8_t amount) {
+  white_mix = amount;
+  settings_changed = true;
+  refresh_kick();
+}
+
 void Adafruit_NeoPXL8HDR::setBrightness(uint8_t b) {
   // Set RGBW, keep existing gamma
   uint16_t b16 = b * 257; // 257 (not 256) is intentional; see setPixelColor()
@@ -945,46 +1902,101 @@ void Adafruit_NeoPXL8HDR::setBrightness(uint16_t r, uint16_t g, uint16_t b,
 
 void Adafruit_NeoPXL8HDR::setBrightness(uint16_t r, uint16_t g, uint16_t b,
                                         uint16_t w, float y) {
-  // Set RGBW+gamma, recalc table
+  // Set RGBW+gamma. Brightness is just a scale applied in refresh(); the
+  // gamma table is only recalculated if gamma actually changes.
   brightness_rgbw[0] = r;
   brightness_rgbw[1] = g;
   brightness_rgbw[2] = b;
   brightness_rgbw[3] = w;
-  gfactor = y;
-  calc_gamma_table();
+  // All four channels are made current at once (see spare_copy()), so a
+  // frame never mixes old and new brightness.
+  uint8_t n = spare_copy(scale_index, scale_held);
+  for (uint8_t c = 0; c < 4; c++) // 0-65535 to 0-65536 (1.0)
+    scale_rgbw[n][c] = brightness_rgbw[c] + (brightness_rgbw[c] >> 15);
+  scale_index = n;
+  if (y != gfactor) {
+    gfactor = y;
+    calc_gamma_table();
+  } else {
+    settings_changed = true; // refresh() output may change
+    refresh_kick();
+  }
 }
 
 void Adafruit_NeoPXL8HDR::calc_gamma_table(void) {
-  for (uint8_t c = 0; c < 4; c++) { // R, G, B, W component
-    // This is normal and intentional here that the peak value is scaled
-    // down very slightly. Each lookup table entry represents both a base
-    // 8-bit brightness level (0-255) and an 8-bit probability of "dithering
-    // up" to the next level. Since there's nowhere "above" 255 to dither
-    // (else it would roll over), at maximum brightness the topmost entry
-    // should be 0xFF00. We could either clip the top of the range or scale
-    // throughout. Since a gamma curve is also likely being applied anyway,
-    // this code opts for scale. This results in up to 65281 (not 65536)
-    // possible levels at full brightness. Since dithering is usually well
-    // under 8 bits, some of this gets truncated on output anyway, all good.
-    // A tiny bit of linearity is snuck in so we don't have a bunch of 0
-    // elements at the bottom.
-    float top = (float)(brightness_rgbw[c] * 0xFF00UL / 0xFFFF);
-    // There's only 256 elements in the gamma table, as a full 16-bit table
-    // would be inordinately large. In-between values are interpolated.
+  // Table is built in a copy refresh() isn't using (see spare_copy()),
+  // then made current, so a frame never sees a partly-rewritten table.
+  // Brightness isn't part of this (see gamma_level()), only the curve
+  // shape, same for all channels.
+  uint8_t n = spare_copy(g16_index, g16_held);
+  uint16_t *g = g16[n];
+  // This is normal and intentional here that the peak value is scaled
+  // down very slightly. Each lookup table entry represents both a base
+  // 8-bit brightness level (0-255) and an 8-bit probability of "dithering
+  // up" to the next level. Since there's nowhere "above" 255 to dither
+  // (else it would roll over), at maximum brightness the topmost entry
+  // should be 0xFF00. We could either clip the top of the range or scale
+  // throughout. Since a gamma curve is also likely being applied anyway,
+  // this code opts for scale. This results in up to 65281 (not 65536)
+  // possible levels at full brightness. Since dithering is usually well
+  // under 8 bits, some of this gets truncated on output anyway, all good.
+  // A tiny bit of linearity is snuck in so we don't have a bunch of 0
+  // elements at the bottom.
+  // There's only 256 elements in the gamma table, as a full 16-bit table
+  // would be inordinately large. In-between values are interpolated.
+  // Linear and the common gamma values in gamma_builtin[] are the same
+  // curve without the float math.
+  const uint16_t *table = NULL;
+  for (uint8_t i = 0; i < sizeof gamma_builtin / sizeof gamma_builtin[0]; i++)
+    if (gfactor == gamma_builtin[i].gamma)
+      table = gamma_builtin[i].table;
+  if (table) {
+    memcpy(g, table, 256 * sizeof(uint16_t));
+  } else if (gfactor == 1.0) {
+    for (int i = 0; i < 256; i++)
+      g[i] = i + (i * (0xFF00 - i) + 127) / 255;
+  } else {
+    float top = (float)0xFF00;
     for (int i = 0; i < 256; i++) {
-      g16[c][i] =
-          i + uint16_t(pow((float)i / 255.0, gfactor) * (top - i) + 0.5);
+      g[i] = i + uint16_t(pow((float)i / 255.0, gfactor) * (top - i) + 0.5);
     }
   }
+  g[256] = g[255]; // Never weighted, but read by interpolation
+  g16_index = n;
+  settings_changed = true; // refresh() output may change
+  refresh_kick();
 }
 
 void Adafruit_NeoPXL8HDR::show(void) {
+  if (dither_loop) {
+    // Render every step of the dither cycle to its own DMA frame, which
+    // the DMA loop then repeats indefinitely. Staging clears each buffer
+    // before filling it, so the loop is stopped while frames are rewritten
+    // (LEDs hold the last frame latched) rather than let DMA send one
+    // half-built, then restarted.
+    if (!loop_frames)
+      return; // begin() not called or failed
+    loop_stop();
+    memcpy(pixel_buf[0], pixel_buf[2], numBytes * sizeof(uint16_t));
+    settings_changed = false;
+    for (dither_index = 0; dither_index < loop_frames; dither_index++) {
+      dither_frame(pixel_buf[0], pixel_buf[0], 0xFF01, 0);
+      stage_to(loop_frame(dither_index));
+    }
+    dither_index = 0;
+    loop_start();
+    return;
+  }
+
   // Called from the main thread of execution. New pixel data (via
   // setPixelColor()) is loaded, but no blend/dither/refresh cycle occurs --
   // that must be done with separate calls to refresh(). Originally had this
   // fall through to the blend/dither code, but syncing the two threads both
   // vying for dither access got ugly fast. Simpler as distinct behaviors.
 #if defined(ARDUINO_ARCH_RP2040)
+  // startRefresh() may run refresh in an interrupt on this same core,
+  // which would deadlock on the mutex if allowed in here.
+  uint32_t irq = refresh_cpu ? save_and_disable_interrupts() : 0;
   mutex_enter_blocking(&mutex); // Sync w/refresh() on other core
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
   xSemaphoreTake(mutex, 100);
@@ -997,12 +2009,31 @@ void Adafruit_NeoPXL8HDR::show(void) {
   }
 #if defined(ARDUINO_ARCH_RP2040)
   mutex_exit(&mutex); // refresh() can resume
+  if (refresh_cpu)
+    restore_interrupts(irq);
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
   xSemaphoreGive(mutex);
 #else
   interrupts();
 #endif
+  blend_fixed = blend_next; // Set by show(usec) or showAt(), else false
+  blend_next = false;
   new_pixels = true; // Next true pass, don't blend new data, show at 100%
+  refresh_kick();
+}
+
+void Adafruit_NeoPXL8HDR::show(uint32_t usec) { showAt(micros() + usec, usec); }
+
+void Adafruit_NeoPXL8HDR::showAt(uint32_t when) {
+  uint32_t usec = when - micros();
+  showAt(when, ((int32_t)usec > 0) ? usec : 0); // Blend from now until then
+}
+
+void Adafruit_NeoPXL8HDR::showAt(uint32_t when, uint32_t usec) {
+  blend_start = when - usec;
+  blend_time = usec;
+  blend_next = true;
+  show();
 }
 
 // 32-bit math requires some tradeoff between the accuracy of frame blending
@@ -1013,22 +2044,198 @@ void Adafruit_NeoPXL8HDR::show(void) {
 #define BSHIFT 6 ///< Bit-shift in fixed-point math
 #define BLEND_MAX_USEC ((0xFFFFFFFF / 0xFF01) << BSHIFT) ///< Resulting max
 
+// Output byte for one gamma-interpolated channel value c (8-bit level in
+// bits 23-16, fraction below), dithered by the fraction's top bits (mask).
+// With a residual pointer (sigma-delta), the fraction is added to that
+// channel's accumulator, the output is bumped up a level when it carries,
+// and the pointer advances to the next channel. Otherwise (ordered), the
+// fraction is compared against this refresh's dither_table level d. Bits
+// dithered are OR'd into frac, to detect when there's nothing to dither.
+static inline uint8_t dither_level(uint32_t c, uint16_t mask, uint16_t d,
+                                   uint8_t *&res, uint32_t &frac) {
+  frac |= c & mask;
+  if (res) {
+    uint16_t sum = *res + ((c & mask) >> 8);
+    *res++ = sum; // Keep low byte as residual for next refresh
+    return (c >> 16) + (sum >> 8);
+  }
+  return (c >> 16) + ((c & mask) > d);
+}
+
+// Gamma-corrected value for one channel, from a 32-bit blend c of two
+// 16-bit pixel values. Weights (see refresh_frame()) are such that the
+// high byte of c is a base index into the gamma table g, and the mid-byte
+// the weighting of the next entry, by which the two are interpolated. w2
+// (and its implied inverse) are gamma table weights. Their sum is always
+// 256, but w2 only goes up to 255, again on purpose and by design. The
+// weight of the second entry should be at most 255/256 -- if it were
+// 256/256, we'd just +1 the base index and use 0 for w2.
+// Brightness is then applied as a scale s (0 to 65536 = 1.0) of the
+// interpolated top 16 bits, which can't overflow 32 bits. The bottom 8
+// bits, lost here, are below any dither fraction anyway.
+static inline uint32_t gamma_level(const uint16_t *g, uint32_t c,
+                                   uint32_t s) {
+  uint8_t idx = c >> 24; // High byte = base gamma table index
+  uint8_t w2 = c >> 16;  // Mid-byte = next-entry weight
+  return ((g[idx] * (256 - w2) + g[idx + 1] * w2) >> 8) * s >> 8;
+}
+
+// Optional color correction of one pixel's gamma_level() values, which are
+// linear duty cycles, so colors mix as light does: a 3x3 matrix m (4.12
+// fixed-point, 4096 = 1.0, or NULL for none) on R/G/B, then for RGBW
+// pixels a fraction (white/256) of the R/G/B minimum moved to W. Only the
+// top 16 bits (output level and dither fraction) are kept, and results
+// are clipped to the 0-0xFF00 range (as from the gamma tables).
+static void color_correct(uint32_t *v, const int16_t *m, uint16_t white) {
+  int32_t c[3] = {(int32_t)(v[0] >> 8), (int32_t)(v[1] >> 8),
+                  (int32_t)(v[2] >> 8)};
+  if (m) {
+    int32_t in[3] = {c[0], c[1], c[2]};
+    for (uint8_t i = 0; i < 3; i++, m += 3) {
+      // Coefficients are limited to +/-2.0, so this can't overflow
+      int32_t sum = (m[0] * in[0] + m[1] * in[1] + m[2] * in[2]) >> 12;
+      c[i] = (sum < 0) ? 0 : (sum > 0xFF00) ? 0xFF00 : sum;
+    }
+  }
+  if (white) {
+    int32_t w = min(c[0], min(c[1], c[2])) * (white + 1) >> 8;
+    c[0] -= w;
+    c[1] -= w;
+    c[2] -= w;
+    w += v[3] >> 8;
+    v[3] = ((w > 0xFF00) ? 0xFF00 : w) << 8;
+  }
+  for (uint8_t i = 0; i < 3; i++)
+    v[i] = c[i] << 8;
+}
+
+// Blend, gamma-correct and dither one frame from p1 & p2 into pixels[], at
+// the current dither_index. Returns OR of all fractions dithered (0 if
+// output is exact).
+uint32_t Adafruit_NeoPXL8HDR::dither_frame(const uint16_t *p1,
+                                           const uint16_t *p2, uint16_t weight1,
+                                           uint16_t weight2) {
+  // This refresh's dither level for each of the 16 Bayer positions. In
+  // ordered mode they're all the same; spatial mode offsets each into the
+  // dither cycle, scaled to its length.
+  uint16_t dt[16], d;
+  uint8_t dither_max = (1 << dither_active) - 1;
+  for (uint8_t k = 0; k < 16; k++) {
+    uint8_t o = (dither_mode == NEOPXL8_DITHER_SPATIAL)
+                    ? (bayer4x4[k] << dither_active) >> 4
+                    : 0;
+    dt[k] = dither_table[(dither_index + o) & dither_max];
+  }
+  uint32_t x = 0, strand_pixels = numLEDs / num_lanes; // Pixel position
+  uint8_t y = 0;                                       // Strand number
+  uint16_t dither_mask = (uint16_t)((1 << dither_active) - 1)
+                         << (16 - dither_active);
+  uint8_t *p;            // NeoPixel dest buf
+  uint8_t *r = residual; // Sigma-delta residuals (same order), or NULL
+  uint32_t v[4];         // Gamma-corrected R/G/B/W components
+  uint32_t frac = 0;     // OR of all fractions actually dithered
+  // Same gamma & brightness all frame
+  const uint16_t *g = g16[hold_copy(g16_index, g16_held)];
+  const uint32_t *s = scale_rgbw[hold_copy(scale_index, scale_held)];
+  const int16_t *m =
+      matrix_on ? color_matrix[hold_copy(matrix_index, matrix_held)] : NULL;
+  bool rgbw = (wOffset != rOffset);
+  bool correct = m || (rgbw && white_mix);
+
+  // Blend values between p1 & p2 buffers (if blending is disabled, p1 & p2
+  // both point to the same data, so we don't need separate code for
+  // blended vs not), then gamma-correct (see gamma_level()).
+
+  if (!rgbw) { // Is an RGB-type strip, 3 bytes/pixel
+    for (uint32_t i = 0; i < numBytes; i += 3) {
+      p = &pixels[i]; // -> NeoPixel lib buffer (8-bit)
+      d = dt[((y & 3) << 2) | (x & 3)];
+      if (++x >= strand_pixels) { // Next pixel is start of next strand
+        x = 0;
+        y++;
+      }
+      v[0] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[0]);
+      v[1] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[1]);
+      v[2] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[2]);
+      if (correct)
+        color_correct(v, m, 0);
+      p[rOffset] = dither_level(v[0], dither_mask, d, r, frac);
+      p[gOffset] = dither_level(v[1], dither_mask, d, r, frac);
+      p[bOffset] = dither_level(v[2], dither_mask, d, r, frac);
+    }
+  } else { // Is a WRGB-type strip, 4 bytes/pixel
+    for (uint32_t i = 0; i < numBytes; i += 4) {
+      // Same as above, with added W channel
+      p = &pixels[i]; // -> NeoPixel lib buffer (8-bit)
+      d = dt[((y & 3) << 2) | (x & 3)];
+      if (++x >= strand_pixels) { // Next pixel is start of next strand
+        x = 0;
+        y++;
+      }
+      v[0] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[0]);
+      v[1] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[1]);
+      v[2] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[2]);
+      v[3] = gamma_level(g, *p1++ * weight1 + *p2++ * weight2, s[3]);
+      if (correct)
+        color_correct(v, m, white_mix);
+      p[rOffset] = dither_level(v[0], dither_mask, d, r, frac);
+      p[gOffset] = dither_level(v[1], dither_mask, d, r, frac);
+      p[bOffset] = dither_level(v[2], dither_mask, d, r, frac);
+      p[wOffset] = dither_level(v[3], dither_mask, d, r, frac);
+    }
+  }
+
+  return frac;
+}
+
 // Called from a second core or a timer interrupt. Blending and dithering
 // occurs, but no new pixel data is loaded, just iterating.
 void Adafruit_NeoPXL8HDR::refresh(void) {
+  if (refresh_frame())
+    Adafruit_NeoPXL8::show();
+}
+
+bool Adafruit_NeoPXL8HDR::refresh_frame(void) {
+
+  // Nothing to do if the last pass found output to be static (see end of
+  // function) and nothing has changed since, or if DMA is looping through
+  // frames precomputed in show().
+  if ((converged && !new_pixels && !settings_changed) || dither_loop)
+    return false;
 
   if (pixel_buf[2]) { // Don't allow refresh until begin() is finished
 
     uint32_t now = micros();
-    uint32_t elapsed = now - last_show_time;
+    uint32_t elapsed = now - blend_origin;
     // Need to limit this to avoid 32-bit overflow later
     if (elapsed > BLEND_MAX_USEC)
       elapsed = BLEND_MAX_USEC;
     if (new_pixels) {
       new_pixels = false;
-      avg_show_interval = ((avg_show_interval * 7) + elapsed + 4) / 8;
-      last_show_time = now;
-      elapsed = 0;
+      blend_done = false;
+      if (blend_fixed) {
+        // show(usec) or showAt(): blend runs on the caller's schedule
+        // rather than the average show() interval, which is left as-is.
+        blend_origin = blend_start;
+        blend_interval = (blend_time > BLEND_MAX_USEC) ? BLEND_MAX_USEC
+                                                       : blend_time;
+        elapsed = now - blend_start;
+        if ((int32_t)elapsed < 0) // Not started yet
+          elapsed = 0;
+        else if (elapsed > BLEND_MAX_USEC)
+          elapsed = BLEND_MAX_USEC;
+      } else {
+        uint32_t interval = now - last_show_time;
+        if (interval > BLEND_MAX_USEC)
+          interval = BLEND_MAX_USEC;
+        avg_show_interval = ((avg_show_interval * 7) + interval + 4) / 8;
+        blend_interval = avg_show_interval;
+        blend_origin = now;
+        elapsed = 0;
+      }
+      last_show_time = now; // Always a real (past) time, see blend_origin
+    } else if (blend_fixed && ((int32_t)(now - blend_origin) < 0)) {
+      elapsed = 0; // Timed blend not started yet
     }
 #if defined(ARDUINO_ARCH_RP2040)
     mutex_enter_blocking(&mutex); // Wait on show() on other thread
@@ -1042,15 +2249,18 @@ void Adafruit_NeoPXL8HDR::refresh(void) {
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
     xSemaphoreGive(mutex);
 #endif
+    settings_changed = false; // Any change from here on is caught next pass
 
     // Blend and/or dither from p1 & p2 into pixels[]
 
     uint16_t weight1, weight2;            // Current/next pixel blend weights
-    if (pixel_buf[0] != pixel_buf[1]) {   // Temporal blending?
-      if (elapsed >= avg_show_interval) { // At or past end of blend
-        weight2 = 0xFF01;                 // Next pixels contribute 100%
-      } else {                            // Start or part way through blend
-        weight2 = 0xFF01 * (elapsed >> BSHIFT) / (avg_show_interval >> BSHIFT);
+    if (pixel_buf[0] != pixel_buf[1]) { // Temporal blending?
+      if (blend_done || (elapsed >= blend_interval) ||
+          !(blend_interval >> BSHIFT)) { // At or past end of blend
+        weight2 = 0xFF01;                // Next pixels contribute 100%
+        blend_done = true; // Stays so, even if micros() wraps around
+      } else {             // Start or part way through blend
+        weight2 = 0xFF01 * (elapsed >> BSHIFT) / (blend_interval >> BSHIFT);
         // Note to Future Self: keep this fixed-point, don't float it!
       }
     } else {
@@ -1071,92 +2281,294 @@ void Adafruit_NeoPXL8HDR::refresh(void) {
     // coarser temporal dithering going on anyway, these tiny differences get
     // quantized away anyway, no great loss.
 
-    uint16_t d = dither_table[dither_index];
-    uint16_t dither_mask = (uint16_t)((1 << dither_bits) - 1)
-                           << (16 - dither_bits);
-    uint8_t *p; // NeoPixel dest buf
-    uint8_t idx, w2;
-    uint32_t c; // R/G/B/W component
-
-    if (wOffset == rOffset) { // Is an RGB-type strip, 3 bytes/pixel
-      for (uint32_t i = 0; i < numBytes; i += 3) {
-        p = &pixels[i]; // -> NeoPixel lib buffer (8-bit)
-
-        // Blend values between p1 & p2 buffers (if blending is disabled,
-        // p1 & p2 both point to the same data, so we don't need separate
-        // code for blended vs not).
-
-        c = *p1++ * weight1 + *p2++ * weight2; // 32-bit result
-        // Determine base index into gamma table (high byte of 32-bit
-        // result), and weighting of next gamma entry.
-        idx = c >> 24; // High byte = base gamma table index
-        w2 = c >> 16;  // Mid-byte = next-entry weight
-        c = g16[0][idx] * (256 - w2) + g16[0][idx + 1] * w2;
-        p[rOffset] = (c >> 16) + ((c & dither_mask) > d);
-        // w2 (and its implied inverse) are gamma table weights. Their sum is
-        // always 256, but w2 only goes up to 255, again on purpose and by
-        // design. The weight of the second entry should be at most 255/256 --
-        // if it were 256/256, we'd just +1 the base index and use 0 for w2;
-
-        // Same operation, green channel
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[1][idx] * (256 - w2) + g16[1][idx + 1] * w2;
-        p[gOffset] = (c >> 16) + ((c & dither_mask) > d);
-
-        // Same operation, blue channel
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[2][idx] * (256 - w2) + g16[2][idx + 1] * w2;
-        p[bOffset] = (c >> 16) + ((c & dither_mask) > d);
-      }
-    } else { // Is a WRGB-type strip, 4 bytes/pixel
-      for (uint32_t i = 0; i < numBytes; i += 4) {
-        // Same as above, with added W channel
-        p = &pixels[i]; // -> NeoPixel lib buffer (8-bit)
-
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[0][idx] * (256 - w2) + g16[0][idx + 1] * w2;
-        p[rOffset] = (c >> 16) + ((c & dither_mask) > d);
-
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[1][idx] * (256 - w2) + g16[1][idx + 1] * w2;
-        p[gOffset] = (c >> 16) + ((c & dither_mask) > d);
-
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[2][idx] * (256 - w2) + g16[2][idx + 1] * w2;
-        p[bOffset] = (c >> 16) + ((c & dither_mask) > d);
-
-        c = *p1++ * weight1 + *p2++ * weight2;
-        idx = c >> 24;
-        w2 = c >> 16;
-        c = g16[3][idx] * (256 - w2) + g16[3][idx + 1] * w2;
-        p[wOffset] = (c >> 16) + ((c & dither_mask) > d);
-      }
-    }
+    uint32_t frac = dither_frame(p1, p2, weight1, weight2);
 
-    Adafruit_NeoPXL8::show();
+    // If blending is off or complete, and no channel has any fraction left
+    // to dither at the current depth, every later pass would send exactly
+    // the same data. Those are skipped until the next show() or brightness
+    // or dither change, leaving the CPU and DMA free for other things.
+    converged =
+        !frac && ((pixel_buf[0] == pixel_buf[1]) || (weight2 == 0xFF01));
 
     // Cycle dither probability. When it rolls over, update FPS estimate.
-    if (++dither_index >= (1 << dither_bits)) {
+    if (++dither_index >= (1 << dither_active)) {
       dither_index = 0;
       elapsed = now - last_fps_time; // Microseconds since last dither rollover
       if (elapsed)                   // Avoid /0 just in case
-        fps = ((fps * 7) + ((1000000UL << dither_bits) / elapsed) + 4) / 8;
+        fps = ((fps * 7) + ((1000000UL << dither_active) / elapsed) + 4) / 8;
       last_fps_time = now;
+      if (flicker_hz) {
+        // Adaptive depth: drop right away if the cycle rate is under the
+        // target, but step back up only with 1/8 to spare, so the depth
+        // doesn't hunt back and forth around the threshold.
+        uint8_t lo = (dither_min < dither_bits) ? dither_min : dither_bits;
+        while ((dither_active > lo) && ((fps >> dither_active) < flicker_hz))
+          dither_active--;
+        if ((dither_active < dither_bits) &&
+            ((fps >> (dither_active + 1)) >= flicker_hz + flicker_hz / 8))
+          dither_active++;
+      }
     }
 
+    return true;
   } // end if (pixel_buf[2])
+
+  return false;
+}
+
+// Automatic refresh (startRefresh()). On RP2040 and SAMD this is driven by
+// DMA: each frame's transfer is followed by a gap (output idle low) that
+// covers the NeoPixel latch time, plus any idle time needed to hold the
+// engine to its CPU share. The end of the gap interrupts, and the handler
+// issues the frame computed on the previous pass, then computes the next
+// one while that transfers. RP2040 times the gap with another DMA channel
+// paced by a DMA timer (interrupting on the other DMA IRQ, so it can be
+// handled on either core), SAMD with a run of zero bytes on the end of
+// the transfer. When output turns static, the chain stops and show() or a
+// settings change restarts it (refresh_kick()). On ESP32S3 a task does the
+// same, sleeping on a notification from the DMA callback.
+
+#if defined(ARDUINO_ARCH_RP2040)
+#define REFRESH_IRQ_N (1 - DMA_IRQ_N) ///< DMA IRQ for startRefresh() gap
+#endif
+
+#if !defined(CONFIG_IDF_TARGET_ESP32S3)
+static Adafruit_NeoPXL8HDR *refresh_ptr = NULL; // startRefresh() object
+#if !defined(ARDUINO_ARCH_RP2040)
+static uint8_t refresh_zero = 0; // Gap descriptor source (no increment)
+#endif
+#endif
+
+bool Adafruit_NeoPXL8HDR::startRefresh(uint8_t cpu) {
+  if (!pixel_buf[2] || refresh_cpu || dither_loop || !cpu)
+    return false;
+#if defined(NEOPXL8_PORT_DMA)
+  if (num_lanes > 8)
+    return false; // PORT DMA 'zeros' aren't low, and TCC1 stops each frame
+#endif
+
+  // DMA time for one frame (bits per strand times bit period)
+  frame_us = (uint32_t)(numLEDs / num_lanes) *
+             ((wOffset == rOffset) ? 24 : 32) * timing.period / 1000;
+  refresh_us = 0;
+  chain_ready = false;
+  chain_idle = true;
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+  refresh_dma = dma_claim_unused_channel(false);
+  refresh_timer = dma_claim_unused_timer(false);
+  if ((refresh_dma < 0) || (refresh_timer < 0)) {
+    if (refresh_dma >= 0)
+      dma_channel_unclaim(refresh_dma);
+    if (refresh_timer >= 0)
+      dma_timer_unclaim(refresh_timer);
+    refresh_dma = refresh_timer = -1;
+    return false;
+  }
+  while (sending) // Any prior refresh() must finish first
+    ;
+
+  // Gap: one transfer per microsecond, length is set for each frame
+  dma_timer_set_fraction(refresh_timer, 1, F_CPU / 1000000);
+  dma_channel_config c = dma_channel_get_default_config(refresh_dma);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, dma_get_timer_dreq(refresh_timer));
+  dma_channel_configure(refresh_dma, &c, &loop_dummy, &loop_dummy, 1, false);
+  refresh_ptr = this;
+  irq_add_shared_handler(REFRESH_IRQ_N == 0 ? DMA_IRQ_0 : DMA_IRQ_1,
+                         refresh_isr,
+                         PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  dma_irqn_set_channel_enabled(REFRESH_IRQ_N, refresh_dma, true);
+  irq_set_enabled(REFRESH_IRQ_N == 0 ? DMA_IRQ_0 : DMA_IRQ_1, true);
+
+  // Data channel chains to the gap, whose interrupt stands in for its own
+  channel_config_set_chain_to(&dma_config, refresh_dma);
+  dma_channel_set_config(dma_channel, &dma_config, false);
+#if (DMA_IRQ_N == 0)
+  dma_channel_set_irq0_enabled(dma_channel, false);
+#else
+  dma_channel_set_irq1_enabled(dma_channel, false);
+#endif
+
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+
+  while (LCD_CAM.lcd_user.lcd_start) // Any prior refresh() must finish
+    ;
+  refresh_cpu = (cpu > 100) ? 100 : cpu;
+  // Task runs on the core opposite the caller (Arduino code is on core 1)
+  if (xTaskCreatePinnedToCore(refresh_task, "NeoPXL8HDR", 4096, this, 0,
+                              &refresh_handle,
+                              xPortGetCoreID() ^ 1) != pdPASS) {
+    refresh_cpu = 0;
+    refresh_handle = NULL;
+    return false;
+  }
+  return true;
+
+#else // SAMD
+
+  // Gap descriptor follows the frame's. ZeroDMA can't remove descriptors,
+  // so this stays once added (stopRefresh() shortens it to one byte).
+  if (!refresh_desc &&
+      !(refresh_desc = dma.addDescriptor(
+            &refresh_zero, &((uint8_t *)(&TCC0->PATT))[1], 1,
+            DMA_BEAT_SIZE_BYTE, false, false)))
+    return false;
+  while (sending) // Any prior refresh() must finish first
+    ;
+  uint32_t gap = (latchtime + 1) * 3000 / timing.period;
+  refresh_desc->BTCNT.reg = (gap > 65535) ? 65535 : gap;
+  refresh_ptr = this;
+  refresh_hook = refresh_isr;
+
+#endif
+
+  refresh_cpu = (cpu > 100) ? 100 : cpu;
+  refresh_kick(); // Start the chain
+  return true;
+}
+
+void Adafruit_NeoPXL8HDR::stopRefresh(void) {
+  if (!refresh_cpu)
+    return;
+  refresh_cpu = 0;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  xTaskNotifyGive(refresh_handle);
+  while (refresh_handle) // Task clears this on its way out
+    delay(1);
+#else
+  while (!chain_idle) // Chain stops at the end of the current transfer
+    ;
+#if defined(ARDUINO_ARCH_RP2040)
+  dma_irqn_set_channel_enabled(REFRESH_IRQ_N, refresh_dma, false);
+  irq_remove_handler(REFRESH_IRQ_N == 0 ? DMA_IRQ_0 : DMA_IRQ_1, refresh_isr);
+  channel_config_set_chain_to(&dma_config, dma_channel);
+  dma_channel_set_config(dma_channel, &dma_config, false);
+#if (DMA_IRQ_N == 0)
+  dma_channel_set_irq0_enabled(dma_channel, true);
+#else
+  dma_channel_set_irq1_enabled(dma_channel, true);
+#endif
+  dma_channel_unclaim(refresh_dma);
+  dma_timer_unclaim(refresh_timer);
+  refresh_dma = refresh_timer = -1;
+#else
+  noInterrupts();
+  refresh_hook = NULL;
+  refresh_desc->BTCNT.reg = 1;
+  interrupts();
+#endif
+  refresh_ptr = NULL;
+#endif
+}
+
+void Adafruit_NeoPXL8HDR::refresh_kick(void) {
+  if (!refresh_cpu)
+    return;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  xTaskNotifyGive(refresh_handle);
+#else
+  if (chain_idle) {
+    chain_idle = false;
+#if defined(ARDUINO_ARCH_RP2040)
+    // Minimal gap, whose interrupt then resumes the chain
+    dma_channel_set_trans_count(refresh_dma, 1, true);
+#else
+    // Nothing else can set off the DMA callback, so re-issue the last
+    // frame (same data, no visible change) and resume after that.
+    sending = 1;
+    dma.startJob();
+    dma.trigger();
+#endif
+  }
+#endif
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+
+void Adafruit_NeoPXL8HDR::refresh_task(void *arg) {
+  Adafruit_NeoPXL8HDR *hdr = (Adafruit_NeoPXL8HDR *)arg;
+  const uint32_t tick_us = portTICK_PERIOD_MS * 1000;
+  uint32_t owed = 0; // Idle time due to stay within CPU share, microseconds
+  while (hdr->refresh_cpu) {
+    uint32_t start = micros();
+    if (hdr->refresh_frame()) {
+      uint32_t busy = micros() - start;
+      // Sleep until the DMA callback says the prior frame is done (with a
+      // short timeout, just in case), rather than spinning in show().
+      while (LCD_CAM.lcd_user.lcd_start)
+        ulTaskNotifyTake(pdTRUE, 1);
+      start = micros();
+      hdr->Adafruit_NeoPXL8::show();
+      busy += micros() - start;
+      owed += busy * (100 - hdr->refresh_cpu) / hdr->refresh_cpu;
+      if (owed >= tick_us) {
+        vTaskDelay(owed / tick_us);
+        owed %= tick_us;
+      }
+    } else {
+      owed = 0;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Static, wait on show() etc.
+    }
+  }
+  while (LCD_CAM.lcd_user.lcd_start) // Let last transfer finish
+    ;
+  refresh_handle = NULL;
+  vTaskDelete(NULL);
 }
 
+#else
+
+void Adafruit_NeoPXL8HDR::refresh_isr(void) {
+#if defined(ARDUINO_ARCH_RP2040)
+  int ch = refresh_ptr->refresh_dma;
+  if (!dma_irqn_get_channel_status(REFRESH_IRQ_N, ch))
+    return;
+  dma_irqn_acknowledge_channel(REFRESH_IRQ_N, ch);
+  sending = 0; // Data channel's own interrupt is disabled
+#endif
+  // Gap included the latch time, no need to wait that out again
+  lastBitTime = micros() - refresh_ptr->latchtime - 1;
+  refresh_ptr->refresh_chain();
+}
+
+void Adafruit_NeoPXL8HDR::refresh_chain(void) {
+  if (!refresh_cpu) { // stopRefresh() is waiting for this
+    chain_idle = true;
+    return;
+  }
+  uint32_t start = micros();
+  if (!chain_ready) // Starting or resuming, nothing computed yet
+    chain_ready = refresh_frame();
+  if (chain_ready) {
+    // Gap after this frame covers the latch and, if CPU is capped, enough
+    // idle time that the last pass's share of the frame period is within
+    // refresh_cpu percent.
+    uint32_t cycle = refresh_us * 100 / refresh_cpu;
+    uint32_t gap = (cycle > frame_us) ? cycle - frame_us : 0;
+    if (gap <= latchtime)
+      gap = latchtime + 1;
+#if defined(ARDUINO_ARCH_RP2040)
+    dma_channel_set_trans_count(refresh_dma, gap, false);
+#else
+    gap = gap * 3000 / timing.period; // Microseconds to bytes
+    refresh_desc->BTCNT.reg = (gap > 65535) ? 65535 : gap;
+#endif
+    Adafruit_NeoPXL8::show();
+    chain_ready = refresh_frame(); // Next frame, while this one transfers
+    refresh_us = micros() - start;
+  } else {
+    chain_idle = true; // Output is static, show() etc. will resume
+    if (new_pixels || settings_changed) // Unless that just happened
+      refresh_kick();
+  }
+}
+
+#endif // end !ESP32S3
+
 // SOME VALUABLE NOTES ABOUT setPixelColor() AND getPixelColor() FUNCTIONS:
 // - These are provided for compatibility with existing NeoPixel or NeoPXL8
 //   sketches moved directly to NeoPXL8HDR. New code may prefer set16()
@@ -1285,6 +2697,146 @@ void Adafruit_NeoPXL8HDR::get16(uint16_t n, uint16_t *r, uint16_t *g,
   }
 }
 
+// NEOPXL8PIPELINE CLASS ---------------------------------------------------
+
+// The two frame slots are handed back and forth between reader and output
+// stages via the ready[] flags: only the reader sets a flag, only output
+// clears it, so no lock is needed even when the stages run on different
+// cores. Memory barriers ensure frame data is complete before a flag
+// changes hands.
+
+Adafruit_NeoPXL8Pipeline::Adafruit_NeoPXL8Pipeline(Adafruit_NeoPXL8 &leds)
+    : leds(leds) {
+  memset(&stats, 0, sizeof stats);
+}
+
+Adafruit_NeoPXL8Pipeline::~Adafruit_NeoPXL8Pipeline(void) { end(); }
+
+bool Adafruit_NeoPXL8Pipeline::begin(uint32_t frameBytes,
+                                     neopxl8_reader_t reader, void *arg,
+                                     neoPixelType order, bool threaded) {
+  end();
+  if (!frameBytes || !reader)
+    return false;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!(slot[i] = (uint8_t *)leds.mem_alloc(frameBytes,
+                                              NEOPXL8_MEM_PIXELS))) {
+      end();
+      return false;
+    }
+    ready[i] = false;
+  }
+  frame_bytes = frameBytes;
+  read_func = reader;
+  read_arg = arg;
+  frame_order = order;
+  threaded_read = threaded;
+  read_index = show_index = 0;
+  eof = false;
+  memset(&stats, 0, sizeof stats);
+  last_frame_time = micros();
+  __sync_synchronize(); // Everything above before running flag
+  running = true;
+  return true;
+}
+
+void Adafruit_NeoPXL8Pipeline::end(void) {
+  running = false;
+  __sync_synchronize();
+  while (reading || showing)
+    yield(); // Let read() or show() on other core finish its frame
+  if (attached) {
+    leds.setFrameBuffer(NULL);
+    attached = false;
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    if (slot[i]) {
+      leds.mem_free(slot[i], NEOPXL8_MEM_PIXELS);
+      slot[i] = NULL;
+    }
+  }
+}
+
+bool Adafruit_NeoPXL8Pipeline::read(void) {
+  bool result = false;
+  reading = true;
+  __sync_synchronize(); // reading flag before running check (see end())
+  if (running && !eof && !ready[read_index]) {
+    uint32_t t = micros(), usec = 0;
+    if (read_func(slot[read_index], frame_bytes, &usec, read_arg)) {
+      slot_usec[read_index] = usec;
+      stats.read = ((stats.read * 7) + (micros() - t) + 4) / 8;
+      __sync_synchronize(); // Frame data before ready flag
+      ready[read_index] = true;
+      read_index ^= 1;
+      result = true;
+    } else {
+      eof = true;
+    }
+  }
+  reading = false;
+  return result;
+}
+
+bool Adafruit_NeoPXL8Pipeline::show(void) {
+  showing = true;
+  __sync_synchronize(); // showing flag before running check (see end())
+  bool result = running && show_frame();
+  showing = false;
+  return result;
+}
+
+bool Adafruit_NeoPXL8Pipeline::show_frame(void) {
+  if (!ready[show_index]) { // Reader is behind
+    if (stats.frames)       // (first frame doesn't count)
+      stats.stalls++;
+    while (!ready[show_index]) {
+      if (!running) // end() on other core is waiting on this
+        return false;
+      if (eof) { // Reader finished; last frame may have just landed
+        __sync_synchronize();
+        if (!ready[show_index])
+          return false;
+      } else if (!threaded_read) {
+        read();
+      } else {
+        yield();
+      }
+    }
+  }
+  __sync_synchronize(); // ready flag before frame data
+  uint8_t *buf = slot[show_index];
+
+  uint32_t t = micros();
+  if (convert_func) {
+    convert_func(buf, frame_bytes, convert_arg);
+    uint32_t now = micros();
+    stats.convert = ((stats.convert * 7) + (now - t) + 4) / 8;
+    t = now;
+  }
+
+  // Hold frame until its interval has elapsed
+  while ((micros() - last_frame_time) < slot_usec[show_index])
+    ;
+  last_frame_time = micros();
+  stats.idle = ((stats.idle * 7) + (last_frame_time - t) + 4) / 8;
+
+  // show() stages (copies) the frame to the DMA buffer before returning,
+  // so the slot can be released to the reader right after.
+  leds.setFrameBuffer(buf, frame_order);
+  attached = true;
+  leds.show();
+  stats.output = ((stats.output * 7) + (micros() - last_frame_time) + 4) / 8;
+  stats.frames++;
+  __sync_synchronize(); // Done with frame data before releasing slot
+  ready[show_index] = false;
+  show_index ^= 1;
+
+  if (!threaded_read)
+    read(); // Fetch next frame while this one transmits
+  return true;
+}
+
 /*--------------------------------------------------------------------------
 Some notes on How It Works (and doesn't work):
 
@@ -1292,8 +2844,10 @@ SAMD21 DMA has no path to the GPIO PORT registers. Instead, one of the
 DMA-capable peripherals is exploited for byte-wide concurrent output
 (specifically the TCC0 pattern generator, which is normally used for
 motor control or some such). Although SAMD51 does have PORT DMA, the
-pattern generator approach is used there regardless, so similar code
-can be used for both chips. On RP2040 and RP235x, PIO code is used.
+pattern generator approach is used there for 8 lanes regardless, so
+similar code can be used for both chips. An experimental 16/32-lane
+SAMD51 mode writes straight to a PORT group's registers instead (see the
+end of these notes). On RP2040 and RP235x, PIO code is used.
 
 To issue 8 bits in parallel, all bytes of NeoPixel data must be "turned
 sideways" in RAM so all the bit 7's are issued concurrently, then all
@@ -1337,4 +2891,20 @@ about everything can't figure out round-robin arbitration on a beat timer.
 If anyone can offer insights there, or point to a SAMD21-compatible example,
 I'd be immensely grateful, as it'd reduce the library's RAM requirements by
 a factor of 2 and we could handle even MOAR pixels.
+
+The 16/32-lane SAMD51 mode (port_begin(), only built if
+NEOPXL8_SAMD51_PORT_DMA is defined) is a second try at that 3-channel
+design, with the differences that seemed likeliest to matter. Each
+channel has its own trigger, a distinct TCC1 compare match (CC0 = data
+word to OUTSET, CC1 = all-lanes mask to OUTSET, CC2 = mask to OUTCLR)
+rather than overflow plus two compares, and each trigger fires at a
+different count within the bit period, so at most one request should be
+pending at a time and arbitration order shouldn't come into it. TCC1 is
+also stopped after the last bit (by a trailing descriptor on the data
+channel) and restarted from zero in show(), so no stray request is left
+pending between frames. That's the theory; it has only been checked
+against the host timing model (extras/neopxl8timing), which can't show
+DMA arbitration behavior, and NOT yet on hardware with a logic
+analyzer. Until it is, it stays off by default, and if it shows the
+same symptoms as above, the note above still stands.
 ----------------------------------------------------------------------------*/
@@ -21,6 +21,7 @@
 #ifndef _ADAFRUIT_NEOPXL8_H_
 #define _ADAFRUIT_NEOPXL8_H_
 
+#include "Adafruit_NeoPXL8Timing.h"
 #include <Adafruit_NeoPixel.h>
 #if defined(ARDUINO_ARCH_RP2040)
 #include "../../hardware_dma/include/hardware/dma.h"
@@ -38,6 +39,136 @@
 #include <Adafruit_ZeroDMA.h>
 #endif
 
+// DMA buffer bytes from one NeoPixel bit to the next. On RP2040 and RP235x,
+// each bit is one byte (PIO generates the high and low states). On SAMD and
+// ESP32S3, each bit is a high/data/low byte triplet.
+#if defined(ARDUINO_ARCH_RP2040)
+#define NEOPXL8_DMA_BIT_STRIDE 1 ///< DMA buffer bytes per NeoPixel bit
+#else
+#define NEOPXL8_DMA_BIT_STRIDE 3 ///< DMA buffer bytes per NeoPixel bit
+#endif
+
+// Most parallel outputs (lanes) supported by the constructor. ESP32S3 can
+// run its LCD peripheral with a 16-bit data bus; DMA data for each bit is
+// then a 16-bit word rather than a byte, strand N on bit N. SAMD51 can
+// write 16 or 32 lanes directly to one PORT group with DMA, one 16- or
+// 32-bit word per bit (no high/low triplets). That mode has not yet been
+// verified on hardware (see "How It Works" in Adafruit_NeoPXL8.cpp), so
+// is only built if NEOPXL8_SAMD51_PORT_DMA is defined as a compiler flag.
+#if defined(__SAMD51__) && defined(NEOPXL8_SAMD51_PORT_DMA)
+#define NEOPXL8_PORT_DMA ///< SAMD51 16/32-lane PORT DMA output is built
+#endif
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#define NEOPXL8_MAX_LANES 16 ///< Max parallel outputs
+#elif defined(NEOPXL8_PORT_DMA)
+#define NEOPXL8_MAX_LANES 32 ///< Max parallel outputs
+#else
+#define NEOPXL8_MAX_LANES 8 ///< Max parallel outputs
+#endif
+
+// Matrix layouts for Adafruit_NeoPXL8::setLayout(). Progressive or
+// serpentine may be combined (OR'd) with vertical.
+#define NEOPXL8_LAYOUT_PROGRESSIVE 0 ///< All rows run left-to-right
+#define NEOPXL8_LAYOUT_SERPENTINE 1  ///< Even rows L-to-R, odd rows R-to-L
+#define NEOPXL8_LAYOUT_VERTICAL 2    ///< Pixels run in columns, not rows
+
+// ALLOCATION HOOKS --------------------------------------------------------
+
+/*!
+  @brief  Kinds of memory requested by NeoPXL8 and NeoPXL8HDR begin(),
+          passed to a custom allocator so it can decide where each buffer
+          should live (e.g. internal SRAM vs. PSRAM on ESP32S3).
+*/
+typedef enum {
+  NEOPXL8_MEM_DMA = 0, ///< DMA buffer, MUST be DMA-reachable internal RAM
+  NEOPXL8_MEM_PIXELS,  ///< Pixel/dither data, only ever touched by the CPU
+} neopxl8_mem_t;
+
+/*!
+  @brief  Custom allocation function, see Adafruit_NeoPXL8::setAllocator().
+          Returns a pointer to at least 'bytes' of RAM of the requested kind
+          (32-bit aligned), or NULL on failure. 'arg' is passed through
+          from setAllocator().
+*/
+typedef void *(*neopxl8_alloc_t)(size_t bytes, neopxl8_mem_t type, void *arg);
+
+/*!
+  @brief  Custom free function, counterpart to neopxl8_alloc_t. Called with
+          the same 'type' and 'arg' as the allocation being released.
+*/
+typedef void (*neopxl8_free_t)(void *ptr, neopxl8_mem_t type, void *arg);
+
+/*!
+  @brief  Simple arena allocator for NeoPXL8 buffers. Carves allocations
+          sequentially from a single user-supplied block of RAM (static or
+          allocated once at startup), and rewinds to the start once every
+          allocation has been released. Repeated begin()/delete cycles
+          (e.g. re-reading a config file and reallocating a differently-
+          sized NeoPXL8 object) then reuse the same memory every time,
+          rather than fragmenting the heap.
+*/
+class Adafruit_NeoPXL8Arena {
+public:
+  /*!
+    @brief  Arena constructor.
+    @param  buf  Pointer to RAM to allocate from. If NeoPXL8 DMA buffers
+                 will come from this arena, it must be DMA-capable memory
+                 (on ESP32S3, that's internal RAM, NOT PSRAM).
+    @param  len  Size of buf in bytes.
+  */
+  Adafruit_NeoPXL8Arena(void *buf, size_t len);
+
+  /*!
+    @brief  Allocate space from the arena.
+    @param  bytes  Number of bytes requested.
+    @return Pointer to 32-bit-aligned space, or NULL if arena is exhausted.
+  */
+  void *alloc(size_t bytes);
+
+  /*!
+    @brief  Release an allocation previously returned by alloc(). Space is
+            not reused individually; the whole arena rewinds once all
+            outstanding allocations are released.
+    @param  ptr  Pointer returned by alloc() (NULL is ignored).
+  */
+  void release(void *ptr);
+
+  /*!
+    @brief  Query arena bytes currently in use.
+    @return Bytes used, including alignment padding.
+  */
+  size_t used(void) const { return top; }
+
+  /*!
+    @brief  Query arena bytes still available.
+    @return Bytes remaining.
+  */
+  size_t available(void) const { return size - top; }
+
+  /*!
+    @brief  neopxl8_alloc_t-compatible hook, 'arg' is the arena object.
+    @param  bytes  Number of bytes requested.
+    @param  type   Memory kind (ignored, the arena has only one kind).
+    @param  arg    Pointer to Adafruit_NeoPXL8Arena object.
+    @return Pointer to allocated space, or NULL on failure.
+  */
+  static void *allocHook(size_t bytes, neopxl8_mem_t type, void *arg);
+
+  /*!
+    @brief  neopxl8_free_t-compatible hook, 'arg' is the arena object.
+    @param  ptr   Pointer previously returned by allocHook().
+    @param  type  Memory kind (ignored).
+    @param  arg   Pointer to Adafruit_NeoPXL8Arena object.
+  */
+  static void freeHook(void *ptr, neopxl8_mem_t type, void *arg);
+
+private:
+  uint8_t *base;  ///< Start of arena (32-bit aligned)
+  size_t size;    ///< Usable size of arena in bytes
+  size_t top;     ///< Offset of next free byte
+  uint16_t count; ///< Number of outstanding allocations
+};
+
 // NEOPXL8 CLASS -----------------------------------------------------------
 
 /*!
@@ -68,8 +199,20 @@ public:
     @param  t
             NeoPixel color data order, same as in Adafruit_NeoPixel library
             (optional, default is GRB).
+    @param  lanes
+            Number of parallel outputs: 8 (default); 16 on ESP32S3; 16 or
+            32 on SAMD51 if built with NEOPXL8_SAMD51_PORT_DMA (not yet
+            verified on hardware). The pin array must have this many entries (-1
+            for unused). Total pixel count is this many times the strand
+            length. Each bit in the DMA buffer is then a 16- or 32-bit
+            word. On SAMD51, 16 or 32 lanes bypass the TCC0 pattern
+            generator. Any pins can be used, but they must all be on one
+            PORT group. With 16 lanes they must also all be in the same
+            half (bits 0-15 or 16-31). Pins that don't fit are disabled.
+            begin() fails if the count is not supported on this chip.
   */
-  Adafruit_NeoPXL8(uint16_t n, int8_t *p = NULL, neoPixelType t = NEO_GRB);
+  Adafruit_NeoPXL8(uint16_t n, int8_t *p = NULL, neoPixelType t = NEO_GRB,
+                   uint8_t lanes = 8);
   ~Adafruit_NeoPXL8(void);
 
   /*!
@@ -83,6 +226,19 @@ public:
   */
   bool begin(bool dbuf = false);
 
+  /*!
+    @brief  Allocate buffers and initialize hardware for NeoPXL8 output,
+            with non-default NeoPixel bit timing (e.g. 400 KHz WS2811, or
+            faster than 800 KHz for chips that tolerate it).
+    @param  timing  Bit timing, e.g. neopxl8_timing_400k, or a custom
+                    neopxl8_timing_t. See Adafruit_NeoPXL8Timing.h for
+                    how closely each platform can match it.
+    @param  dbuf    As in begin(bool).
+    @return true on successful alloc/init, false otherwise (including
+            timing not possible at this CPU speed).
+  */
+  bool begin(const neopxl8_timing_t &timing, bool dbuf = false);
+
   /*!
     @brief  Process and issue new data to the NeoPixel strands.
   */
@@ -113,6 +269,130 @@ public:
   */
   bool canStage(void) const;
 
+  /*!
+    @brief  Stage pixel data directly from an external framebuffer (e.g. a
+            video decode buffer) rather than the NeoPixel pixel buffer,
+            skipping the per-pixel setPixelColor() pass entirely. Each
+            subsequent stage() or show() reads from this buffer, applying
+            color reordering and brightness on the fly. Pixels are in
+            NeoPXL8 order -- strand 0 first, then strand 1 and so forth.
+    @param  buf           Pointer to frame data, or NULL to resume using the
+                          internal NeoPixel buffer (setPixelColor() etc.).
+                          The buffer must remain valid until replaced.
+    @param  order         Byte order of each pixel in buf, using the same
+                          constants as the NeoPixel library (NEO_RGB,
+                          NEO_GRB, NEO_RGBW, etc.). This is the order of
+                          the SOURCE data, independent of the strand's own
+                          color order passed to the constructor. If source
+                          has no W and strands do, W is 0; if strands have
+                          no W, any W in source is ignored. Default NEO_RGB.
+    @param  pixelStride   Bytes from one source pixel to the next, or 0
+                          (default) for 3 or 4 as implied by order. Larger
+                          values skip padding, e.g. 4 for RGBX pixels.
+    @param  strandStride  Bytes from the first pixel of one strand to the
+                          first pixel of the next, or 0 (default) for a
+                          packed frame (strand length * pixelStride).
+                          Larger values skip row padding.
+    @note   getPixelColor() and friends continue to operate on the internal
+            NeoPixel buffer and do not see this data. Not for NeoPXL8HDR,
+            which stages from its own 16-bit buffers.
+  */
+  void setFrameBuffer(const uint8_t *buf, neoPixelType order = NEO_RGB,
+                      uint8_t pixelStride = 0, uint32_t strandStride = 0);
+
+  /*!
+    @brief  Describe how the NeoPixels are physically arranged in a 2D
+            matrix, so that a row-major image passed to setFrameBuffer()
+            lands on the correct pixels when staged. A compact mapping
+            table (2 bytes per pixel) is built once here and used by every
+            subsequent stage(), so there's no per-pixel index math in user
+            code. Call again to change, or clearLayout() to discard.
+    @param  width        Matrix width in pixels.
+    @param  height       Matrix height in pixels. width * height must
+                         be at least the total pixel count (lanes X
+                         strand length), and at most 65536 (table
+                         entries are 16-bit). Any matrix positions past
+                         the pixel count, e.g. if strand length was
+                         rounded down, are dropped.
+    @param  layout       Pixel arrangement within each tile:
+                         NEOPXL8_LAYOUT_PROGRESSIVE (default) or
+                         NEOPXL8_LAYOUT_SERPENTINE, optionally OR'd with
+                         NEOPXL8_LAYOUT_VERTICAL if pixels run in columns.
+                         Values 0 and 1 match the led_layout setting used
+                         in the video examples' neopxl8.cfg.
+    @param  rotation     Image rotation on the matrix, 0-3 (x 90 degrees
+                         clockwise). With 1 or 3, the source image is
+                         height pixels wide and width pixels tall.
+    @param  tilesAcross  If the matrix is assembled from multiple identical
+                         tiles, number of tiles horizontally (default 1).
+                         Pixels run through each tile in turn, tiles in
+                         row-major order. Must divide evenly into width.
+    @param  tilesDown    Number of tiles vertically (default 1). Must
+                         divide evenly into height.
+    @return true on success, false on invalid arguments or insufficient
+            RAM for the mapping table (prior layout, if any, is kept).
+    @note   Mapping applies only when staging from setFrameBuffer(), in
+            which case the strandStride argument there is not used.
+  */
+  bool setLayout(uint16_t width, uint16_t height,
+                 uint8_t layout = NEOPXL8_LAYOUT_PROGRESSIVE,
+                 uint8_t rotation = 0, uint8_t tilesAcross = 1,
+                 uint8_t tilesDown = 1);
+
+  /*!
+    @brief  Get a pointer to the DMA buffer that the next stage() would
+            fill, for code that generates DMA-ready data on its own (e.g.
+            pre-transposed video, see Adafruit_NeoPXL8Video.h). Data for
+            each NeoPixel bit is NEOPXL8_DMA_BIT_STRIDE bytes apart (or
+            16-bit words, with 16 lanes); on SAMD and ESP32S3 this points
+            to the first high/data/low triplet. SAMD51 with 16 or 32 lanes
+            is the exception: one data word per bit, no triplets. Wait for
+            canStage() before writing here, and follow with setStaged()
+            and show().
+    @return Pointer to DMA buffer, or NULL if begin() has not succeeded.
+  */
+  uint8_t *getStageBuffer(void) const;
+
+  /*!
+    @brief  Query the size of the region returned by getStageBuffer().
+    @return Size in bytes (pixel count * bytes per pixel *
+            NEOPXL8_DMA_BIT_STRIDE, or without the stride for SAMD51 with
+            16 or 32 lanes).
+  */
+  uint32_t getStageBufferSize(void) const;
+
+  /*!
+    @brief  Inform the library that getStageBuffer() was filled directly,
+            so the next show() transmits it as-is rather than calling
+            stage(). Brightness is NOT applied to such data.
+  */
+  void setStaged(void) { staged = true; }
+
+  /*!
+    @brief  Query the DMA bitmask assigned to a strand. Each strand's data
+            occupies one bit of each DMA byte (or word), but which bit
+            depends on the pin assignment and chip. Code that generates DMA
+            data on its own must use these masks.
+    @param  strand  Strand index, 0 to getLanes()-1.
+    @return Bitmask, or 0 if strand is disabled (pin -1 or invalid).
+  */
+  uint32_t getBitmask(uint8_t strand) const {
+    return (strand < num_lanes) ? bitmask[strand] : 0;
+  }
+
+  /*!
+    @brief  Query the number of parallel outputs, as passed to the
+            constructor. Strand length is numPixels() / getLanes().
+    @return Lane count, 8, 16 or 32.
+  */
+  uint8_t getLanes(void) const { return num_lanes; }
+
+  /*!
+    @brief  Discard a mapping table previously created with setLayout(),
+            framebuffer is then staged in NeoPXL8 pixel order again.
+  */
+  void clearLayout(void);
+
   // Brightness is stored differently here than in normal NeoPixel library.
   // In either case it's *specified* the same: 0 (off) to 255 (brightest).
   // Classic NeoPixel rearranges this internally so 0 is max, 1 is off and
@@ -158,6 +438,60 @@ public:
   */
   void setLatchTime(uint16_t us = 300) { latchtime = us; };
 
+  /*!
+    @brief  Provide custom allocation functions for the buffers created in
+            begin(). MUST be called BEFORE begin(), and the same allocator
+            is then used to release buffers when the object is destroyed.
+            Each request is tagged with its kind (NEOPXL8_MEM_DMA or
+            NEOPXL8_MEM_PIXELS), so for example large pixel buffers can be
+            placed in PSRAM while DMA buffers stay in internal RAM. The
+            NeoPixel pixel buffer (allocated by the Adafruit_NeoPixel
+            constructor) is moved into custom memory as well.
+    @param  a    Allocation function, or NULL to restore default malloc().
+    @param  f    Free function (may be NULL if memory is never released,
+                 e.g. static buffers).
+    @param  arg  Optional pointer passed through to a() and f().
+  */
+  void setAllocator(neopxl8_alloc_t a, neopxl8_free_t f = NULL,
+                    void *arg = NULL) {
+    alloc_func = a;
+    free_func = f;
+    alloc_arg = arg;
+  }
+
+  /*!
+    @brief  Allocate all NeoPXL8 buffers from an Adafruit_NeoPXL8Arena.
+            MUST be called BEFORE begin().
+    @param  arena  Arena object; must remain in scope for the life of
+                   this NeoPXL8 object.
+  */
+  void setAllocator(Adafruit_NeoPXL8Arena &arena) {
+    setAllocator(Adafruit_NeoPXL8Arena::allocHook,
+                 Adafruit_NeoPXL8Arena::freeHook, &arena);
+  }
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  /*!
+    @brief  Ready-made ESP32S3 allocation hook, places NEOPXL8_MEM_PIXELS
+            requests in PSRAM (falling back on internal RAM if PSRAM is not
+            present or full) and NEOPXL8_MEM_DMA requests in DMA-capable
+            internal RAM. Pass to setAllocator() with allocPSRAM/freePSRAM.
+    @param  bytes  Number of bytes requested.
+    @param  type   Memory kind.
+    @param  arg    Unused.
+    @return Pointer to allocated space, or NULL on failure.
+  */
+  static void *allocPSRAM(size_t bytes, neopxl8_mem_t type, void *arg);
+
+  /*!
+    @brief  Counterpart to allocPSRAM().
+    @param  ptr   Pointer previously returned by allocPSRAM().
+    @param  type  Memory kind.
+    @param  arg   Unused.
+  */
+  static void freePSRAM(void *ptr, neopxl8_mem_t type, void *arg);
+#endif
+
 #if defined(ARDUINO_ARCH_RP2040)
   /*!
     @brief  Callback function used internally by the DMA transfer interrupt.
@@ -169,7 +503,95 @@ public:
   void dma_callback(void);
 #endif
 
+  friend class Adafruit_NeoPXL8Pipeline; ///< Allocates frames via mem_alloc()
+
 protected:
+  /*!
+    @brief  Allocate memory through the custom allocator if one was set,
+            else malloc() (or DMA-capable heap on ESP32S3).
+    @param  bytes  Number of bytes requested.
+    @param  type   Memory kind.
+    @return Pointer to allocated space, or NULL on failure.
+  */
+  void *mem_alloc(size_t bytes, neopxl8_mem_t type);
+
+  /*!
+    @brief  Release memory obtained from mem_alloc().
+    @param  ptr   Pointer previously returned by mem_alloc().
+    @param  type  Memory kind, same as passed to mem_alloc().
+  */
+  void mem_free(void *ptr, neopxl8_mem_t type);
+
+  /*!
+    @brief  Convert NeoPixel buffer (or framebuffer) to DMA output format,
+            as stage(), into a given buffer.
+    @param  buf  Start of pixel data, as getStageBuffer() would return.
+  */
+  void stage_to(uint8_t *buf);
+
+  /*!
+    @brief  stage_to() worker, templated on the DMA word type (uint8_t for
+            8 lanes, uint16_t for 16, uint32_t for 32) and the words per
+            NeoPixel bit (3 for high/data/low triplets, else 1).
+    @param  buf  Start of pixel data.
+  */
+  template <typename T, uint8_t stride> void stage_lanes(uint8_t *buf);
+
+  /*!
+    @brief  Set up a DMA loop that repeatedly issues a fixed series of
+            frames, with a latch gap after each, with no CPU involvement
+            (see Adafruit_NeoPXL8HDR::setDitherLoop()). Call after begin().
+            show() must not be used once the loop is running.
+    @param  frames  Number of frames in loop, a power of 2, 1-256.
+    @return true on success, false if memory or DMA resources are not
+            available, or the output mode doesn't support it (SAMD51 PORT
+            DMA).
+  */
+  bool loop_begin(uint16_t frames);
+
+  /*!
+    @brief  Get a DMA loop frame, for stage_to().
+    @param  n  Frame index, 0 to loop_begin() count - 1.
+    @return Start of frame's pixel data.
+  */
+  uint8_t *loop_frame(uint16_t n) const {
+    return n ? &loop_buf[(n - 1) * loop_stride] : getStageBuffer();
+  }
+
+  /*!
+    @brief  Start DMA loop, if not already running.
+  */
+  void loop_start(void);
+
+  /*!
+    @brief  Stop DMA loop, if running, leaving it set up so frames can be
+            restaged and loop_start() called again. Output goes idle
+            (low) wherever the loop was, and loop_start() waits out the
+            latch time from then.
+  */
+  void loop_stop(void);
+
+  /*!
+    @brief  Stop DMA loop, if running, release its resources and restore
+            the output DMA setup from begin(), so show() works again. On
+            SAMD, loop_begin() can only be used once per object (the
+            DMA descriptors it adds can't be released).
+  */
+  void loop_end(void);
+
+#if defined(NEOPXL8_PORT_DMA)
+  /*!
+    @brief  begin() for SAMD51 PORT DMA output (16 or 32 lanes).
+    @param  bytesPerPixel  3 or 4.
+    @return true on successful alloc/init, false otherwise.
+  */
+  bool port_begin(uint8_t bytesPerPixel);
+#endif
+
+  neopxl8_alloc_t alloc_func = NULL; ///< Custom allocator, if set
+  neopxl8_free_t free_func = NULL;   ///< Custom free function, if set
+  void *alloc_arg = NULL;            ///< Passed through to custom alloc/free
+  bool pixels_custom = false;        ///< pixels[] came from custom allocator
 #if defined(ARDUINO_ARCH_RP2040)
   PIO pio = NULL; ///< PIO peripheral
   uint sm = -1;   ///< State machine #
@@ -186,18 +608,51 @@ protected:
   DmacDescriptor *desc;     ///< DMA descriptor pointer
   uint8_t *allocAddr;       ///< Allocated buffer into which dmaBuf points
   uint32_t *alignedAddr[2]; ///< long-aligned ptrs into dmaBuf
+#if defined(NEOPXL8_PORT_DMA)
+  Adafruit_ZeroDMA port_dma[2]; ///< PORT DMA 'set all' & 'clear all' chans
+  uint32_t port_mask;           ///< PORT DMA bits of all enabled lanes
+#endif
 #endif
-  int8_t pins[8];                    ///< Pin list for 8 NeoPixel strips
-  uint8_t bitmask[8];                ///< Pattern generator bitmask for each pin
+  int8_t pins[NEOPXL8_MAX_LANES];      ///< Pin list for NeoPixel strips
+  uint32_t bitmask[NEOPXL8_MAX_LANES]; ///< DMA bitmask for each pin
+  uint8_t num_lanes;                   ///< Parallel outputs, 8, 16 or 32
+
   uint8_t *dmaBuf[2] = {NULL, NULL}; ///< Buffer for pixel data + any extra
   uint16_t brightness = 255;         ///< Brightness (stored 1-256, not 0-255)
-  bool staged;                       ///< If set, data is ready for DMA trigger
+  bool staged = false;               ///< If set, data is ready for DMA trigger
   uint16_t latchtime = 300;          ///< Pixel data latch time, microseconds
+  neopxl8_timing_t timing;           ///< Bit timing used by begin()
   uint8_t dbuf_index = 0;            ///< 0/1 DMA buffer index
+  const uint8_t *frame_buf = NULL;   ///< External framebuffer, if set
+  uint32_t frame_strand_stride;      ///< Bytes between strands in frame_buf
+  uint8_t frame_pixel_stride;        ///< Bytes between pixels in frame_buf
+  uint8_t frame_offset[4];           ///< Source byte for each output byte
+  uint16_t *frame_map = NULL;        ///< setLayout() pixel mapping table
+
+  uint8_t *loop_alloc = NULL; ///< DMA loop allocation, NULL if none
+  uint8_t *loop_buf = NULL;   ///< Loop frames 1+ (frame 0 is stage buffer)
+  uint32_t loop_stride = 0;   ///< Bytes between loop frames
+  uint16_t loop_frames = 0;   ///< Frames in DMA loop, 0 if none
+  bool looping = false;       ///< DMA loop is running
+#if defined(ARDUINO_ARCH_RP2040)
+  int loop_dma[2] = {-1, -1}; ///< Latch gap & control DMA channels
+  int loop_timer = -1;        ///< DMA pacing timer for latch gap
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+  dma_descriptor_t *loop_desc = NULL; ///< Circular descriptor list
+#endif
 };
 
 // NEOPXL8HDR CLASS --------------------------------------------------------
 
+/*!
+  @brief  Temporal dithering methods for Adafruit_NeoPXL8HDR::setDither().
+*/
+typedef enum {
+  NEOPXL8_DITHER_ORDERED = 0, ///< Bit-reversed table, 2^bits refresh cycle
+  NEOPXL8_DITHER_SIGMA_DELTA, ///< Per-channel error accumulator (more RAM)
+  NEOPXL8_DITHER_SPATIAL,     ///< Ordered, phase varies by pixel position
+} neopxl8_dither_t;
+
 /*!
   @brief Adafruit_NeoPXL8HDR is a subclass of Adafruit_NeoPXL8 with
          additions for 16-bits-per-channel color, temporal dithering,
@@ -228,8 +683,12 @@ public:
     @param  t
             NeoPixel color data order, same as in Adafruit_NeoPixel library
             (optional, default is GRB).
+    @param  lanes
+            Number of parallel outputs, 8 (default), 16 or 32. See
+            Adafruit_NeoPXL8 constructor.
   */
-  Adafruit_NeoPXL8HDR(uint16_t n, int8_t *p = NULL, neoPixelType t = NEO_GRB);
+  Adafruit_NeoPXL8HDR(uint16_t n, int8_t *p = NULL, neoPixelType t = NEO_GRB,
+                      uint8_t lanes = 8);
   ~Adafruit_NeoPXL8HDR();
 
   /*!
@@ -247,9 +706,100 @@ public:
                    can be NeoPXL8-staged while the prior is in mid-transfer.
                    Might yield slightly improved frame rates in some cases,
                    others just waste RAM. Currently ignored on SAMD.
+    @param  brightness  Initial brightness, as in setBrightness(uint16_t,
+                        float). Default is 65535 (max).
+    @param  y           Initial gamma, as in setBrightness(uint16_t, float).
+                        Default is 1.0 (linear).
     @return true on successful alloc/init, false otherwise.
+    @note   Passing the sketch's brightness and gamma here, rather than
+            calling setBrightness() right after, builds the gamma table
+            just once. Linear, 2.2, 2.6 and 2.8 gamma use prebuilt or
+            integer-only tables, with no float math at startup.
   */
-  bool begin(bool blend = false, uint8_t bits = 4, bool dbuf = false);
+  bool begin(bool blend = false, uint8_t bits = 4, bool dbuf = false,
+             uint16_t brightness = 65535, float y = 1.0);
+
+  /*!
+    @brief  Allocate buffers and initialize hardware for NeoPXL8 output,
+            with non-default NeoPixel bit timing.
+    @param  timing  Bit timing, as in Adafruit_NeoPXL8::begin().
+    @param  blend   As in begin(bool, uint8_t, bool, uint16_t, float).
+    @param  bits    As in begin(bool, uint8_t, bool, uint16_t, float).
+    @param  dbuf    As in begin(bool, uint8_t, bool, uint16_t, float).
+    @param  brightness  As in begin(bool, uint8_t, bool, uint16_t, float).
+    @param  y       As in begin(bool, uint8_t, bool, uint16_t, float).
+    @return true on successful alloc/init, false otherwise.
+  */
+  bool begin(const neopxl8_timing_t &timing, bool blend = false,
+             uint8_t bits = 4, bool dbuf = false, uint16_t brightness = 65535,
+             float y = 1.0);
+
+  /*!
+    @brief  Select temporal dithering method. Call BEFORE begin().
+    @param  mode  NEOPXL8_DITHER_ORDERED (default) compares each channel's
+                  fractional level against a fixed sequence repeating
+                  every 2^bits refreshes, so full depth is only reached
+                  over that whole cycle. NEOPXL8_DITHER_SIGMA_DELTA instead
+                  keeps a running residual for every channel of every
+                  pixel, carrying accumulated error into the next refresh.
+                  Average level is then correct over much shorter spans,
+                  so slow refresh (long strands) flickers less for the
+                  same depth, at the cost of 1 byte of RAM per channel
+                  (e.g. 3 per RGB pixel). begin()'s bits argument still
+                  sets the fractional precision used. Residuals start out
+                  staggered in a 4x4 pattern (see below) so pixels of the
+                  same color don't all step together.
+                  NEOPXL8_DITHER_SPATIAL uses the same sequence as ordered
+                  dither, but each pixel starts at a different point in it,
+                  from a 4x4 Bayer matrix indexed by pixel position along
+                  its strand and by strand number. Neighboring pixels then
+                  change level on different refreshes, rather than the
+                  whole strip stepping in lockstep, so slower refresh or
+                  more dither bits are tolerable. No extra RAM, negligible
+                  extra time.
+  */
+  void setDither(neopxl8_dither_t mode) { dither_mode = mode; }
+
+  /*!
+    @brief  Let dither depth follow the measured refresh rate. bits passed
+            to begin() becomes the maximum; after each dither cycle the
+            depth is lowered if a full cycle (2^bits refreshes) would take
+            longer than 1/hz, or raised again when there's comfortable
+            headroom. Deeper dither gives more intermediate shades, but
+            below some cycle rate (depending on the viewer and content)
+            the cycle becomes visible as flicker.
+    @param  minBits  Lowest depth to use, 0-8 (capped at begin()'s bits).
+    @param  hz       Minimum dither cycle rate, e.g. 60-120 Hz, or 0 to
+                     disable and return to begin()'s fixed depth.
+    @note   Can be called before or after begin(). If before, depth
+            starts at the minimum and climbs as getFPS() settles.
+  */
+  void setAdaptiveDither(uint8_t minBits, uint16_t hz = 100);
+
+  /*!
+    @brief  Precompute dithering in show() and let DMA repeat the result.
+            Call BEFORE begin(). show() then renders all 2^bits steps of
+            the dither cycle (bits as passed to begin()) into separate DMA
+            buffers, and a DMA loop issues them over and over, with a
+            latch gap after each, with no further CPU involvement at all.
+            refresh() does nothing (and needn't be called) in this mode.
+            Frame blending, double buffering and setAdaptiveDither() are
+            not available, and brightness/gamma changes take effect on the
+            next show().
+    @param  enable  true to use precomputed DMA loop, false (default) to
+                    dither in refresh().
+    @note   DMA RAM use is 2^bits times that of a single frame, so fewer
+            bits (or shorter strands) are likely. Not supported with
+            SAMD51 PORT DMA (16 or 32 lanes); begin() returns false.
+  */
+  void setDitherLoop(bool enable) { dither_loop = enable; }
+
+  /*!
+    @brief   Query dither depth currently in use.
+    @return  Bits, 0 to begin()'s bits argument. Always equal to the latter
+             unless setAdaptiveDither() is in effect.
+  */
+  uint8_t getDitherBits(void) const { return dither_active; }
 
   /*!
     @brief  Set peak output brightness for all channels (RGB and W if
@@ -260,13 +810,11 @@ public:
             16-bit adjustment plus gamma correction.
     @param  b  Brightness value, 0-255. This is the LEDs' maximum duty
                cycle and is not itself gamma-corrected.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even.
   */
   void setBrightness(uint8_t b);
 
@@ -277,13 +825,13 @@ public:
                cycle and is not itself gamma-corrected.
     @param  y  Gamma exponent; 1.0 is linear, 2.6 is a typical correction
                factor for NeoPixels.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even. A change of gamma
+            recalculates the gamma table (slow without an FPU), built in a
+            spare copy that refresh() switches to between frames.
             Note to future self: do NOT provide a default gamma value here,
             it MUST be specified, even if 1.0. This avoids ambiguity with
             the back-compatible setBrightness(uint8_t) above without weird
@@ -299,13 +847,11 @@ public:
                and is not itself gamma-corrected.
     @param  g  Green brightness value, 0-65535.
     @param  b  Blue brightness value, 0-65535.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even.
   */
   void setBrightness(uint16_t r, uint16_t g, uint16_t b);
 
@@ -318,13 +864,11 @@ public:
     @param  b  Blue brightness value, 0-65535.
     @param  w  White brightness value, 0-65535. Ignored if NeoPixel strips
                are RGB variety with no W.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even.
   */
   void setBrightness(uint16_t r, uint16_t g, uint16_t b, uint16_t w);
 
@@ -337,13 +881,13 @@ public:
     @param  b  Blue brightness value, 0-65535.
     @param  y  Gamma exponent; 1.0 is linear, 2.6 is a typical correction
                factor for NeoPixels.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even. A change of gamma
+            recalculates the gamma table (slow without an FPU), built in a
+            spare copy that refresh() switches to between frames.
   */
   void setBrightness(uint16_t r, uint16_t g, uint16_t b, float y);
 
@@ -358,28 +902,120 @@ public:
                are RGB variety with no W.
     @param  y  Gamma exponent; 1.0 is linear, 2.6 is a typical correction
                factor for NeoPixels.
-    @note   This is typically set once at program startup and is not
-            intended as an animation effect in itself, partly because the
-            top value is an duty cycle and not a gamma-corrected level.
-            Also, pixels will likely flash if this is called on an active
-            NeoPXL8HDR object, as gamma tables are rewritten while
-            blending/dithering is occurring. Well-designed animation code
-            should handle its own fades!
+    @note   Brightness is a per-channel scale applied in refresh(), so
+            changing it takes only microseconds and is safe on an active
+            NeoPXL8HDR object (e.g. for global fades or night dimming).
+            But the value is a duty cycle, not a gamma-corrected level,
+            so equal steps won't look perceptually even. A change of gamma
+            recalculates the gamma table (slow without an FPU), built in a
+            spare copy that refresh() switches to between frames.
   */
   void setBrightness(uint16_t r, uint16_t g, uint16_t b, uint16_t w, float y);
 
+  /*!
+    @brief  Set a 3x3 color correction matrix (e.g. for LED bin matching
+            or white balance), applied to every pixel in refresh() after
+            gamma correction and brightness, so colors mix linearly as
+            light does. Costs a few multiplies per pixel; none if unset.
+    @param  m  Array of nine coefficients, row-major: output red is
+               m[0] * red + m[1] * green + m[2] * blue, and so forth for
+               green (m[3] to m[5]) and blue (m[6] to m[8]). Each is
+               clipped to +/-2.0 and stored as fixed-point (12 bits of
+               fraction). Results are clipped to the valid range. NULL
+               (default) removes the matrix.
+  */
+  void setColorMatrix(const float *m = NULL);
+
+  /*!
+    @brief  With RGBW pixels, move some or all of the part common to red,
+            green and blue (the smallest of the three) into the white
+            channel, in refresh(). Applied after setColorMatrix(), if any.
+            Ignored on RGB pixels.
+    @param  amount  Portion to move, 0 (default, off) to 255 (all).
+  */
+  void setWhiteExtraction(uint8_t amount = 0);
+
   /*!
     @brief  Provide new pixel data to the refresh handler (but does not
             actually refresh the strip - use refresh() for that).
   */
   void show(void);
 
+  /*!
+    @brief  As show(), but with an explicit blend time (if begin() enabled
+            blending) rather than the average interval between show()
+            calls, which suits bursty or irregular frame sources.
+    @param  usec  Microseconds from now to blend fully to the new pixels.
+                  0 shows them on the next refresh, no blend.
+  */
+  void show(uint32_t usec);
+
+  /*!
+    @brief  As show(), with a presentation timestamp: the blend (if begin()
+            enabled blending) reaches the new pixels exactly at the given
+            time, starting from now.
+    @param  when  micros() value at which new pixels should be shown in
+                  full. If already past, they're shown on the next refresh.
+  */
+  void showAt(uint32_t when);
+
+  /*!
+    @brief  As show(), with a presentation timestamp and blend time: the
+            prior pixels are held until (when - usec), then blend over
+            usec microseconds to reach the new pixels at 'when'.
+    @param  when  micros() value at which new pixels should be shown in
+                  full.
+    @param  usec  Blend duration, microseconds, up to about 4 seconds.
+    @note   Without blending (see begin()), these timed variants behave
+            the same as show().
+  */
+  void showAt(uint32_t when, uint32_t usec);
+
   /*!
     @brief  Dither (and blend, if enabled) and issue new data to the
             NeoPixel strands.
+    @note   Once output stops changing between calls -- blending is off
+            or finished, and every channel is an exact level at the
+            current dither depth -- further calls return immediately
+            without recomputing or retransmitting anything, until the
+            next show() or brightness/gamma/dither change.
   */
   void refresh(void);
 
+  /*!
+    @brief  Have the library call refresh() on its own, so the sketch
+            needn't provide a loop1() function, FreeRTOS task or timer
+            interrupt for it. Call after begin(). Each refresh is set off
+            by the end of the prior DMA transfer, and the next frame is
+            computed while the current one is issued, for the highest
+            rate the hardware allows, unless capped by the cpu argument.
+            - RP2040/RP235x: runs in a DMA interrupt on the core that
+              calls startRefresh() -- call it from setup1() to keep it
+              off the core running loop(). Uses one more DMA channel and
+              a DMA timer, which times the latch and any idle gap.
+            - ESP32S3: runs in a FreeRTOS task on the core NOT calling
+              startRefresh() (core 0 from Arduino setup()), which sleeps
+              while DMA is busy or output is static.
+            - SAMD: runs in the DMA interrupt. A run of zero bytes after
+              each frame times the latch and any idle gap.
+    @param  cpu  Maximum percentage (1-100) of the CPU core's time to
+                 spend on refresh; lower values leave more for the sketch
+                 (or WiFi, etc.) at the expense of refresh rate. Default
+                 is 100, no cap.
+    @return true on success, false if begin() wasn't called (or failed),
+            refresh is already started, setDitherLoop() is in effect, or
+            resources (DMA channel or timer, task) are unavailable. Also
+            false on SAMD51 with 16 or 32 lanes, which isn't supported.
+    @note   Don't call refresh() from the sketch once started.
+  */
+  bool startRefresh(uint8_t cpu = 100);
+
+  /*!
+    @brief  Stop automatic refresh started with startRefresh(), freeing
+            any resources it used. On RP2040, call from the same core.
+  */
+  void stopRefresh(void);
+
   /*!
     @brief  Overload the stage() function from Adafruit_NeoPXL8.
             Does nothing in NeoPXL8HDR, provided for compatibility.
@@ -517,19 +1153,104 @@ protected:
             brightness/gamma-setting functions.
   */
   void calc_gamma_table(void);
-  float gfactor;                               ///< Gamma: 1.0=linear, 2.6=typ
+
+  /*!
+    @brief  Blend, gamma-correct and dither one frame into the NeoPixel
+            buffer, at the current dither_index. Used internally.
+    @param  p1       Previous frame (16-bit RGB/RGBW).
+    @param  p2       Next frame.
+    @param  weight1  Weight of p1, weight1 + weight2 = 0xFF01.
+    @param  weight2  Weight of p2.
+    @return Bitwise OR of all fractional bits dithered, 0 if exact.
+  */
+  uint32_t dither_frame(const uint16_t *p1, const uint16_t *p2,
+                        uint16_t weight1, uint16_t weight2);
+
+  /*!
+    @brief  Blend and dither the next frame into the NeoPixel buffer, but
+            don't issue it. Used internally by refresh() and the automatic
+            refresh engine.
+    @return true if a frame was produced and should be shown, false if
+            not ready (begin() not finished) or output is static.
+  */
+  bool refresh_frame(void);
+
+  /*!
+    @brief  One step of the interrupt-driven refresh engine (RP2040, SAMD):
+            issue the frame computed on the prior step, then compute the
+            next while that's transferring. Used internally.
+  */
+  void refresh_chain(void);
+
+  /*!
+    @brief  Restart an idle refresh engine, after new pixel data or
+            settings. Used internally.
+  */
+  void refresh_kick(void);
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  /*!
+    @brief  Refresh engine FreeRTOS task. Used internally.
+    @param  arg  NeoPXL8HDR object.
+  */
+  static void refresh_task(void *arg);
+#else
+  /*!
+    @brief  Refresh engine DMA interrupt handler (RP2040) or DMA callback
+            hook (SAMD). Used internally.
+  */
+  static void refresh_isr(void);
+#endif
+  float gfactor = 0.0;                         ///< Gamma: 1.0=linear, 2.6=typ
   uint16_t *pixel_buf[3] = {NULL, NULL, NULL}; ///< Buffer for NeoPXL8 staging
   uint16_t *dither_table = NULL;               ///< Temporal dithering lookup
   uint32_t last_show_time = 0;                 ///< micros() @ last show()
   uint32_t avg_show_interval = 0;              ///< Avergage uS between show()
   uint32_t fps = 0;                            ///< Estimated refreshes/second
   uint32_t last_fps_time = 0;                  ///< micros() @ last estimate
-  uint16_t g16[4][256];                        ///< Gamma look up table
+  uint16_t g16[3][257];                        ///< Gamma table, 3 copies
   uint16_t brightness_rgbw[4];                 ///< Peak brightness/channel
+  uint32_t scale_rgbw[3][4];                   ///< Brightness, 3 copies
+  volatile uint8_t scale_index = 0;            ///< scale_rgbw[] copy current
+  volatile uint8_t scale_held = 0;             ///< Copy held by refresh()
+  volatile uint8_t g16_index = 0;              ///< g16[] copy current
+  volatile uint8_t g16_held = 0;               ///< Copy held by refresh()
   uint8_t dither_bits;                         ///< # bits for temporal dither
-  uint8_t dither_index = 0;                    ///< Current dither_table pos
+  uint16_t dither_index = 0;                   ///< Current dither_table pos
   uint8_t stage_index = 0;                     ///< Ping-pong pixel_buf
   volatile bool new_pixels = true;             ///< show()/refresh() sync
+
+  uint8_t *residual = NULL;               ///< Sigma-delta residuals or NULL
+  neopxl8_dither_t dither_mode;           ///< Ordered, sigma-delta or spatial
+  uint16_t flicker_hz = 0;                ///< Adaptive dither target, 0 = off
+  uint8_t dither_min = 0;                 ///< Adaptive dither minimum bits
+  uint8_t dither_active = 0;              ///< Dither bits currently in use
+  bool converged = false;                 ///< refresh() output is static
+  volatile bool settings_changed = false; ///< Brightness etc. changed
+  bool dither_loop = false;               ///< Precomputed DMA loop mode
+  volatile uint8_t refresh_cpu = 0;       ///< startRefresh() cap, 0 = off
+  volatile bool chain_idle = true;        ///< Engine waiting on refresh_kick
+  bool chain_ready = false;               ///< Frame waiting to be issued
+  uint32_t refresh_us = 0;                ///< Engine time for last frame
+  uint32_t frame_us = 0;                  ///< DMA time for one frame
+  uint32_t blend_start = 0;               ///< show(usec)/showAt() start
+  uint32_t blend_origin = 0;              ///< micros() @ current blend 0%
+  uint32_t blend_time = 0;                ///< show(usec)/showAt() duration
+  uint32_t blend_interval = 0;            ///< Current blend duration, uS
+  volatile bool blend_next = false;       ///< Timed show() in progress
+  volatile bool blend_fixed = false;      ///< Blend uses blend_start/time
+  bool blend_done = false;                ///< Blend reached new pixels
+  int16_t color_matrix[3][9];             ///< setColorMatrix(), 4.12
+  volatile bool matrix_on = false;        ///< color_matrix[] in use
+  volatile uint8_t matrix_index = 0;      ///< color_matrix[] copy current
+  volatile uint8_t matrix_held = 0;       ///< Copy held by refresh() frame
+  uint8_t white_mix = 0;                  ///< setWhiteExtraction() amount
+#if defined(ARDUINO_ARCH_RP2040)
+  int refresh_dma = -1;   ///< Latch & idle gap DMA channel
+  int refresh_timer = -1; ///< DMA pacing timer for gap
+#elif !defined(CONFIG_IDF_TARGET_ESP32S3)
+  DmacDescriptor *refresh_desc = NULL; ///< Latch & idle gap descriptor
+#endif
 #if defined(ARDUINO_ARCH_RP2040)
   mutex_t mutex; ///< For synchronizing cores
 #elif defined(CONFIG_IDF_TARGET_ESP32S3)
@@ -537,6 +1258,149 @@ protected:
 #endif
 };
 
+// PLAYBACK PIPELINE -------------------------------------------------------
+
+/*!
+  @brief  Reader stage function for Adafruit_NeoPXL8Pipeline, e.g. reading
+          one video frame from a file.
+  @param  buf   Frame buffer to fill.
+  @param  len   Size of buf in bytes (frameBytes passed to begin()).
+  @param  usec  Set this to the interval, in microseconds, between the
+                previous frame's output and this frame's (0 = immediate).
+  @param  arg   Value passed to begin(), for any use.
+  @return true if a frame was read, false at end of stream or on error
+          (pipeline then stops reading).
+*/
+typedef bool (*neopxl8_reader_t)(uint8_t *buf, uint32_t len, uint32_t *usec,
+                                 void *arg);
+
+/*!
+  @brief  Converter stage function for Adafruit_NeoPXL8Pipeline, modifies
+          a frame in place (e.g. gamma correction) just before output.
+  @param  buf  Frame buffer.
+  @param  len  Size of buf in bytes.
+  @param  arg  Value passed to setConverter(), for any use.
+*/
+typedef void (*neopxl8_converter_t)(uint8_t *buf, uint32_t len, void *arg);
+
+/*!
+  @brief  Adafruit_NeoPXL8Pipeline timing statistics. Stage times are
+          running averages in microseconds.
+*/
+typedef struct {
+  uint32_t read;    ///< Reader stage time per frame
+  uint32_t convert; ///< Converter stage time per frame
+  uint32_t output;  ///< Output stage (stage() + DMA start) time per frame
+  uint32_t idle;    ///< Time output held a ready frame until its interval
+  uint32_t frames;  ///< Total frames output
+  uint32_t stalls;  ///< Frames that were not read in time for output
+} neopxl8_pipeline_stats_t;
+
+/*!
+  @brief  Double-buffered frame playback pipeline for Adafruit_NeoPXL8.
+          A reader stage fills one of two frame buffers while the other is
+          converted, staged and transmitted, so file I/O overlaps with
+          output. Frames are passed to setFrameBuffer(), so setLayout() may
+          be used for matrix arrangement. On RP2040, RP235x and ESP32S3,
+          read() may be called in a loop on one core while show() runs on
+          the other (see VideoMSC example); on single-core devices, show()
+          calls read() itself right after starting each DMA transfer.
+          Not for use with Adafruit_NeoPXL8HDR.
+*/
+class Adafruit_NeoPXL8Pipeline {
+public:
+  /*!
+    @brief  Pipeline constructor.
+    @param  leds  Adafruit_NeoPXL8 object for output, which must have
+                  begin()'d successfully before calling show().
+  */
+  Adafruit_NeoPXL8Pipeline(Adafruit_NeoPXL8 &leds);
+  ~Adafruit_NeoPXL8Pipeline(void);
+
+  /*!
+    @brief  Allocate frame buffers and start the pipeline.
+    @param  frameBytes  Size of one frame in bytes, usually pixel count *
+                        3 or 4 as implied by order.
+    @param  reader      Reader stage function.
+    @param  arg         Passed to reader, for any use.
+    @param  order       Byte order of frame data, as for setFrameBuffer().
+    @param  threaded    true if the sketch calls read() from another core
+                        or task, false (default) to have show() call it.
+    @return true on success, false on allocation error.
+  */
+  bool begin(uint32_t frameBytes, neopxl8_reader_t reader, void *arg = NULL,
+             neoPixelType order = NEO_RGB, bool threaded = false);
+
+  /*!
+    @brief  Stop the pipeline, detach from NeoPXL8 and free frame buffers.
+            If read() or show() runs on another core, this waits for any
+            frame in progress to finish.
+  */
+  void end(void);
+
+  /*!
+    @brief  Set (or clear) an optional converter stage.
+    @param  func  Converter function, or NULL for none.
+    @param  arg   Passed to func, for any use.
+  */
+  void setConverter(neopxl8_converter_t func, void *arg = NULL) {
+    convert_func = func;
+    convert_arg = arg;
+  }
+
+  /*!
+    @brief  Reader stage: if a frame buffer is free, fill it. Call this in
+            a loop on another core or task if begin() was passed
+            threaded=true.
+    @return true if a frame was read, false if no buffer was free, at end
+            of stream, or if pipeline is not running.
+  */
+  bool read(void);
+
+  /*!
+    @brief  Converter and output stages: wait for the next frame to be
+            read and its interval to elapse, then convert and show() it.
+    @return true if a frame was shown, false once the reader has reached
+            end of stream and all frames are output, or if pipeline is not
+            running.
+  */
+  bool show(void);
+
+  /*!
+    @brief  Query timing statistics.
+    @return Reference to statistics, updated as pipeline runs.
+  */
+  const neopxl8_pipeline_stats_t &getStats(void) const { return stats; }
+
+protected:
+  /*!
+    @brief  show() worker, called with the showing flag set.
+    @return As show().
+  */
+  bool show_frame(void);
+
+  Adafruit_NeoPXL8 &leds;                  ///< Output object
+  uint8_t *slot[2] = {NULL, NULL};         ///< Frame buffers (leds' memory)
+  uint32_t slot_usec[2];                   ///< Interval for each frame
+  volatile bool ready[2];                  ///< If set, slot holds a frame
+  volatile bool running = false;           ///< If set, begin() succeeded
+  volatile bool reading = false;           ///< If set, read() in progress
+  volatile bool showing = false;           ///< If set, show() in progress
+  volatile bool eof = false;               ///< If set, reader has finished
+  bool threaded_read = false;              ///< If set, read() is external
+  bool attached = false;                   ///< If set, slot given to leds
+  uint8_t read_index = 0;                  ///< Next slot for reader
+  uint8_t show_index = 0;                  ///< Next slot for output
+  uint32_t frame_bytes = 0;                ///< Size of each slot
+  uint32_t last_frame_time = 0;            ///< micros() at last output
+  neoPixelType frame_order = NEO_RGB;      ///< Byte order of frames
+  neopxl8_reader_t read_func = NULL;       ///< Reader stage
+  void *read_arg = NULL;                   ///< Reader argument
+  neopxl8_converter_t convert_func = NULL; ///< Converter stage, if any
+  void *convert_arg = NULL;                ///< Converter argument
+  neopxl8_pipeline_stats_t stats;          ///< Timing statistics
+};
+
 // The DEFAULT_PINS macros provide shortcuts for the most commonly-used pin
 // lists on certain boards. For example, with a Feather M0, the default list
 // will match an unaltered, factory-fresh NeoPXL8 FeatherWing M0. If ANY pins
@@ -0,0 +1,404 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * @file Adafruit_NeoPXL8DMX.h
+ *
+ * E1.31 (sACN) and Art-Net packet decoder for Adafruit_NeoPXL8 and
+ * Adafruit_NeoPXL8HDR. DMX universes and channel ranges are mapped once to
+ * pixel ranges of a NeoPXL8 pixel buffer (or any framebuffer), building a
+ * copy plan of a few contiguous runs per universe, so each incoming packet
+ * costs little more than a memcpy(). Packets come from any transport
+ * (WiFi, Ethernet, or a file on a host computer); this code has no Arduino
+ * dependencies.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef _ADAFRUIT_NEOPXL8DMX_H_
+#define _ADAFRUIT_NEOPXL8DMX_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NEOPXL8_E131_PORT 5568   ///< E1.31 (sACN) UDP port
+#define NEOPXL8_ARTNET_PORT 6454 ///< Art-Net UDP port
+#define NEOPXL8_DMX_CHANNELS 512 ///< Channels per DMX universe
+
+/*!
+  @brief  Result of Adafruit_NeoPXL8DMX::parse().
+*/
+typedef enum {
+  NEOPXL8_DMX_NONE = 0, ///< Not a packet for us, invalid, or out of order
+  NEOPXL8_DMX_DATA,     ///< Universe data copied to buffer
+  NEOPXL8_DMX_SHOW,     ///< Frame is complete, call show() now
+} neopxl8_dmx_result_t;
+
+/*!
+  @brief  Maps DMX universes onto a pixel buffer and decodes E1.31 and
+          Art-Net packets into it. The buffer may be the NeoPXL8 object's
+          own (getPixels(), in the strands' native color order, and
+          unaffected by setBrightness() until staged), a framebuffer passed
+          to setFrameBuffer() (in which case that function's color order
+          argument describes the DMX data), or the 16-bit buffer of a
+          NeoPXL8HDR object (8-bit DMX values are expanded to 16 bits).
+
+          parse() reports when to show() a frame. If the sender uses
+          synchronization (E1.31 sync address, or Art-Net ArtSync), that's
+          on each sync packet. Otherwise, it's once every mapped universe
+          has been received, or if one repeats before that (so a missing
+          universe doesn't stall output). If sync packets stop arriving,
+          unsynchronized operation resumes after a few frames' worth of
+          data packets.
+
+          Universe numbers are as they appear in packets: 1 to 63999 for
+          E1.31, and the 15-bit port address (net, subnet and universe) for
+          Art-Net, which starts from 0. Packet priority and multiple
+          sources are not handled; the last packet received wins.
+*/
+class Adafruit_NeoPXL8DMX {
+public:
+  /*!
+    @brief  Constructor for an 8-bit pixel buffer.
+    @param  buf            Pixel buffer, e.g. Adafruit_NeoPXL8::getPixels().
+    @param  numPixels      Number of pixels in buffer.
+    @param  bytesPerPixel  3 for RGB (default), 4 for RGBW. DMX channels
+                           per pixel are the same.
+  */
+  Adafruit_NeoPXL8DMX(uint8_t *buf, uint32_t numPixels,
+                      uint8_t bytesPerPixel = 3)
+      : buf8(buf), buf16(NULL), num_pixels(numPixels), bpp(bytesPerPixel) {}
+
+  /*!
+    @brief  Constructor for a 16-bit pixel buffer.
+    @param  buf            Pixel buffer, e.g.
+                           Adafruit_NeoPXL8HDR::getPixels().
+    @param  numPixels      Number of pixels in buffer.
+    @param  bytesPerPixel  3 for RGB (default), 4 for RGBW (this is DMX
+                           channels per pixel; the buffer has twice as
+                           many bytes).
+  */
+  Adafruit_NeoPXL8DMX(uint16_t *buf, uint32_t numPixels,
+                      uint8_t bytesPerPixel = 3)
+      : buf8(NULL), buf16(buf), num_pixels(numPixels), bpp(bytesPerPixel) {}
+
+  ~Adafruit_NeoPXL8DMX() { clearMap(); }
+
+  /*!
+    @brief  Map channels of one universe to a range of pixels.
+    @param  universe  Universe number (see class notes).
+    @param  channel   First DMX channel, 1 to 512.
+    @param  pixel     First pixel index in buffer. For NeoPXL8, that's
+                      strand * strand length + pixel along the strand.
+    @param  count     Number of pixels. The universe must hold them all,
+                      i.e. channel + count * bytesPerPixel - 1 <= 512.
+    @return true on success, false on invalid range or allocation error.
+  */
+  bool map(uint16_t universe, uint16_t channel, uint32_t pixel,
+           uint16_t count) {
+    uint32_t length = count * bpp;
+    if (!channel || !count || (channel - 1 + length > NEOPXL8_DMX_CHANNELS) ||
+        (pixel >= num_pixels) || (count > num_pixels - pixel))
+      return false;
+    neopxl8_dmx_run_t run = {(uint16_t)(channel - 1), (uint16_t)length,
+                             pixel * bpp};
+
+    // Find (or insert) universe, keeping list sorted for binary search
+    uint16_t u = 0;
+    while ((u < num_universes) && (universes[u].universe < universe))
+      u++;
+    if ((u == num_universes) || (universes[u].universe != universe)) {
+      void *p = realloc(universes, (num_universes + 1) * sizeof *universes);
+      if (!p)
+        return false;
+      universes = (neopxl8_dmx_universe_t *)p;
+      memmove(&universes[u + 1], &universes[u],
+              (num_universes - u) * sizeof *universes);
+      memset(&universes[u], 0, sizeof *universes);
+      universes[u].universe = universe;
+      universes[u].first_run =
+          (u < num_universes) ? universes[u + 1].first_run : num_runs;
+      num_universes++;
+    }
+
+    // Extend universe's last run if this continues it, else insert a run
+    // at the end of the universe's block of runs
+    neopxl8_dmx_universe_t *un = &universes[u];
+    uint16_t r = un->first_run + un->num_runs;
+    if (un->num_runs) {
+      neopxl8_dmx_run_t *last = &runs[r - 1];
+      if ((last->channel + last->length == run.channel) &&
+          (last->offset + last->length == run.offset)) {
+        last->length += run.length;
+        return true;
+      }
+    }
+    void *p = realloc(runs, (num_runs + 1) * sizeof *runs);
+    if (!p)
+      return false;
+    runs = (neopxl8_dmx_run_t *)p;
+    memmove(&runs[r + 1], &runs[r], (num_runs - r) * sizeof *runs);
+    runs[r] = run;
+    num_runs++;
+    un->num_runs++;
+    for (uint16_t i = u + 1; i < num_universes; i++)
+      universes[i].first_run++;
+    return true;
+  }
+
+  /*!
+    @brief  Map a range of pixels to consecutive universes, filling each
+            from channel 1 (the usual arrangement for pixel controllers).
+    @param  universe     First universe number.
+    @param  pixel        First pixel index in buffer.
+    @param  count        Total number of pixels.
+    @param  perUniverse  Pixels per universe, or 0 (default) for as many
+                         as fit (170 for RGB, 128 for RGBW).
+    @return true on success, false on invalid range or allocation error.
+  */
+  bool mapUniverses(uint16_t universe, uint32_t pixel, uint32_t count,
+                    uint16_t perUniverse = 0) {
+    if (!perUniverse)
+      perUniverse = NEOPXL8_DMX_CHANNELS / bpp;
+    while (count) {
+      uint16_t n = (count < perUniverse) ? count : perUniverse;
+      if (!map(universe++, 1, pixel, n))
+        return false;
+      pixel += n;
+      count -= n;
+    }
+    return true;
+  }
+
+  /*!
+    @brief  Discard all mappings and statistics.
+  */
+  void clearMap(void) {
+    free(universes);
+    free(runs);
+    universes = NULL;
+    runs = NULL;
+    num_universes = num_runs = fresh = 0;
+    synced = false;
+  }
+
+  /*!
+    @brief  Decode one UDP packet payload. E1.31 data and sync packets
+            and Art-Net ArtDmx and ArtSync packets are recognized; any
+            others, or data for universes not mapped, are ignored.
+    @param  data  Packet payload.
+    @param  len   Payload length in bytes.
+    @return NEOPXL8_DMX_SHOW if the frame should be displayed now,
+            NEOPXL8_DMX_DATA if data was stored, else NEOPXL8_DMX_NONE.
+  */
+  neopxl8_dmx_result_t parse(const uint8_t *data, uint32_t len) {
+    static const uint8_t acn[12] = {'A', 'S', 'C', '-', 'E', '1',
+                                    '.', '1', '7', 0,   0,   0};
+    if ((len >= 44) && !memcmp(&data[4], acn, sizeof acn)) {
+      uint32_t vector = be32(&data[18]);
+      if (vector == 0x00000004) { // E1.31 data
+        // Framing vector 2, DMP vector 2, address type 0xA1, start code 0
+        if ((len < 126) || (be32(&data[40]) != 0x00000002) ||
+            (data[117] != 0x02) || (data[118] != 0xA1) || data[125])
+          return NEOPXL8_DMX_NONE;
+        if (data[112] & 0xC0) // Preview data, or stream terminated
+          return NEOPXL8_DMX_NONE;
+        uint32_t count = be16(&data[123]) - 1; // Less start code
+        if ((count > NEOPXL8_DMX_CHANNELS) || (126 + count > len))
+          return NEOPXL8_DMX_NONE;
+        // Sender's sync address; if 0, it's not synchronizing
+        if (!(sync_address = be16(&data[109])))
+          synced = false;
+        return receive(be16(&data[113]), data[111], 256, &data[126], count);
+      } else if (vector == 0x00000008) { // E1.31 extended: sync
+        if ((len < 47) || (be32(&data[40]) != 0x00000001) || !sync_address ||
+            (be16(&data[45]) != sync_address))
+          return NEOPXL8_DMX_NONE;
+        return sync_show();
+      }
+    } else if ((len >= 14) && !memcmp(data, "Art-Net", 8)) {
+      uint16_t op = data[8] | (data[9] << 8);
+      if (op == 0x5000) { // ArtDmx
+        uint32_t count = (len >= 18) ? be16(&data[16]) : 0;
+        if (!count || (count > NEOPXL8_DMX_CHANNELS) || (18 + count > len))
+          return NEOPXL8_DMX_NONE;
+        uint16_t universe = data[14] | ((data[15] & 0x7F) << 8);
+        // Sequence 0 means not used, else it wraps from 255 to 1
+        return receive(universe, data[12], data[12] ? 255 : 0, &data[18],
+                       count);
+      } else if (op == 0x5200) { // ArtSync
+        return sync_show();
+      }
+    }
+    return NEOPXL8_DMX_NONE;
+  }
+
+  /*!
+    @brief  Count of packets received for a universe.
+    @param  universe  Universe number.
+    @return Packet count, or 0 if universe is not mapped.
+  */
+  uint32_t getPackets(uint16_t universe) const {
+    const neopxl8_dmx_universe_t *u = find(universe);
+    return u ? u->packets : 0;
+  }
+
+  /*!
+    @brief  Count of packets lost for a universe, from gaps in sequence
+            numbers. Late or duplicate packets are discarded and also
+            counted here.
+    @param  universe  Universe number.
+    @return Lost packet count, or 0 if universe is not mapped.
+  */
+  uint32_t getLost(uint16_t universe) const {
+    const neopxl8_dmx_universe_t *u = find(universe);
+    return u ? u->lost : 0;
+  }
+
+  /*!
+    @brief  Check whether the sender is synchronizing output.
+    @return true if show() is being triggered by sync packets.
+  */
+  bool isSynced(void) const { return synced; }
+
+private:
+  /*!
+    @brief  One contiguous copy from a universe's data to the buffer.
+  */
+  typedef struct {
+    uint16_t channel; ///< First DMX channel, from 0
+    uint16_t length;  ///< Number of channels
+    uint32_t offset;  ///< Index of first buffer element
+  } neopxl8_dmx_run_t;
+
+  /*!
+    @brief  Copy plan and statistics for one universe.
+  */
+  typedef struct {
+    uint16_t universe;  ///< Universe number
+    uint16_t first_run; ///< Index of first copy run
+    uint16_t num_runs;  ///< Number of copy runs
+    uint8_t seq;        ///< Sequence number of last packet
+    bool have_seq;      ///< If set, seq is valid
+    bool fresh;         ///< If set, received since last show
+    uint32_t packets;   ///< Packets received
+    uint32_t lost;      ///< Packets missed, late or duplicated
+  } neopxl8_dmx_universe_t;
+
+  static uint16_t be16(const uint8_t *p) { return (p[0] << 8) | p[1]; }
+  static uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) |
+           p[3];
+  }
+
+  // Binary search for mapped universe
+  neopxl8_dmx_universe_t *find(uint16_t universe) const {
+    int lo = 0, hi = num_universes - 1;
+    while (lo <= hi) {
+      int mid = (lo + hi) / 2;
+      if (universes[mid].universe == universe)
+        return &universes[mid];
+      if (universes[mid].universe < universe)
+        lo = mid + 1;
+      else
+        hi = mid - 1;
+    }
+    return NULL;
+  }
+
+  // Handle universe data. modulus is 256 for E1.31 sequence numbers, 255
+  // for Art-Net's (1-255), 0 if unsequenced.
+  neopxl8_dmx_result_t receive(uint16_t universe, uint8_t seq,
+                               uint16_t modulus, const uint8_t *data,
+                               uint32_t count) {
+    neopxl8_dmx_universe_t *u = find(universe);
+    if (!u)
+      return NEOPXL8_DMX_NONE;
+    if (modulus) {
+      if (u->have_seq) {
+        // As in E1.31, a packet up to 20 behind is late (or duplicate)
+        // and discarded; anything else is newer.
+        uint16_t d = (seq + modulus - u->seq) % modulus;
+        if (!d || (d > modulus - 20)) {
+          u->lost++;
+          return NEOPXL8_DMX_NONE;
+        }
+        u->lost += d - 1;
+      }
+      u->seq = seq;
+      u->have_seq = true;
+    }
+    u->packets++;
+
+    const neopxl8_dmx_run_t *run = &runs[u->first_run];
+    for (uint16_t r = 0; r < u->num_runs; r++, run++) {
+      if (run->channel >= count)
+        continue; // Short packet
+      uint32_t n = count - run->channel;
+      if (n > run->length)
+        n = run->length;
+      const uint8_t *src = &data[run->channel];
+      if (buf8) {
+        memcpy(&buf8[run->offset], src, n);
+      } else {
+        uint16_t *dst = &buf16[run->offset];
+        for (uint32_t i = 0; i < n; i++)
+          dst[i] = src[i] * 257;
+      }
+    }
+
+    if (synced) {
+      // Assume sync has stopped if this many data packets go without it
+      if (++since_sync <= num_universes * 4)
+        return NEOPXL8_DMX_DATA;
+      synced = false;
+    }
+    if (u->fresh) { // Repeat before all universes seen
+      clear_fresh();
+      u->fresh = true;
+      fresh = 1;
+      return NEOPXL8_DMX_SHOW;
+    }
+    u->fresh = true;
+    if (++fresh < num_universes)
+      return NEOPXL8_DMX_DATA;
+    clear_fresh();
+    return NEOPXL8_DMX_SHOW;
+  }
+
+  // Handle sync packet
+  neopxl8_dmx_result_t sync_show(void) {
+    synced = true;
+    since_sync = 0;
+    clear_fresh();
+    return NEOPXL8_DMX_SHOW;
+  }
+
+  void clear_fresh(void) {
+    for (uint16_t i = 0; i < num_universes; i++)
+      universes[i].fresh = false;
+    fresh = 0;
+  }
+
+  uint8_t *buf8;                            ///< 8-bit pixel buffer
+  uint16_t *buf16;                          ///< 16-bit pixel buffer
+  uint32_t num_pixels;                      ///< Pixels in buffer
+  neopxl8_dmx_universe_t *universes = NULL; ///< Mapped, by number
+  neopxl8_dmx_run_t *runs = NULL;           ///< Copy runs, by universe
+  uint16_t num_universes = 0;               ///< Size of universes[]
+  uint16_t num_runs = 0;                    ///< Size of runs[]
+  uint16_t fresh = 0;                       ///< Universes since show
+  uint16_t sync_address = 0;                ///< E1.31 sync universe
+  uint32_t since_sync = 0;                  ///< Data packets since sync
+  uint8_t bpp;                              ///< Channels per pixel
+  bool synced = false;                      ///< If set, show on sync
+};
+
+#endif // _ADAFRUIT_NEOPXL8DMX_H_
@@ -0,0 +1,457 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * @file Adafruit_NeoPXL8Timing.h
+ *
+ * Timing model for the NeoPixel bit waveforms generated by Adafruit_NeoPXL8
+ * on each platform: the RP2040/RP2350 PIO program and its fractional clock
+ * divider, the SAMD TCC0 pattern generator period, the SAMD51 PORT DMA
+ * compare values, and the ESP32-S3 LCD_CAM clock divider. From a clock
+ * configuration this computes the actual (best and worst case) high and
+ * low times of '0' and '1' bits and the minimum reset (latch) interval,
+ * and checks these against datasheet limits for common LED chips. It also
+ * derives those clock settings from a requested timing (neopxl8_timing_t,
+ * see begin()). This code has no Arduino dependencies, so it can be
+ * evaluated on a host computer (see extras/neopxl8timing).
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef _ADAFRUIT_NEOPXL8TIMING_H_
+#define _ADAFRUIT_NEOPXL8TIMING_H_
+
+#include <math.h>
+#include <stdint.h>
+
+// Each NeoPixel bit is output in three phases: high (always), data (high
+// for '1' bits, low for '0') and low (always). Durations of each phase,
+// in units of the output clock:
+
+// RP2040/RP2350 PIO program (neopxl8_opcodes[] in Adafruit_NeoPXL8.cpp):
+// 'mov pins, !null' is the high phase, 'mov pins, osr' the data, then
+// 'mov pins, null' and 'pull block' the low phase. Delays on the 'mov'
+// instructions set the phase lengths, see neopxl8_pio_config().
+#define NEOPXL8_PIO_QUEUE 9 ///< Bits still in TX FIFO + OSR at DMA IRQ
+// SAMD and ESP32-S3: one DMA byte per phase (0xFF/data/0x00 triplets).
+#define NEOPXL8_BEAT_HIGH 1       ///< DMA beats, high phase
+#define NEOPXL8_BEAT_DATA 1       ///< DMA beats, data phase
+#define NEOPXL8_BEAT_LOW 1        ///< DMA beats, low phase
+#define NEOPXL8_SAMD_LEADIN 24    ///< Zero bytes ahead of SAMD data
+#define NEOPXL8_SAMD_LEADIN_US 30 ///< Latch wait reduction for lead-in
+// SAMD pattern generator DMA needs several clocks per beat, more with
+// other bus traffic; 10 (PER 9) is twice the default rate at 48 MHz.
+#define NEOPXL8_TCC_MIN_PER 9 ///< Shortest TCC0 period accepted by begin()
+// SAMD51 PORT DMA (16 or 32 lanes): timer clocks from the start of each bit
+// period to the first of its three DMA writes.
+#define NEOPXL8_PORT_LEAD 1 ///< TCC clocks before first write of each bit
+
+// CHIP SPECIFICATIONS -----------------------------------------------------
+
+/*!
+  @brief  LED chip timing limits, from manufacturer datasheets. High and
+          low times are min/max pairs in nanoseconds.
+*/
+typedef struct {
+  const char *name; ///< Chip name
+  uint32_t t0h[2];  ///< '0' bit high time
+  uint32_t t1h[2];  ///< '1' bit high time
+  uint32_t t0l[2];  ///< '0' bit low time
+  uint32_t t1l[2];  ///< '1' bit low time
+  uint16_t reset;   ///< Minimum reset (latch) low time, microseconds
+} neopxl8_chip_spec_t;
+
+/*!
+  Datasheet timings for common chips. Datasheet limits are conservative:
+  most chips sample the data line at a fixed delay after each rising edge,
+  and tolerate considerably longer high and low times than stated (up to
+  a few microseconds low, short of a reset), so a chip outside these
+  ranges may still work. A '0' high time past a chip's sampling point, or
+  a '1' high time short of it, will not.
+*/
+static const neopxl8_chip_spec_t neopxl8_chip_specs[] = {
+    // Name, T0H, T1H, T0L, T1L (min, max ns), reset (us)
+    {"WS2812B", {250, 550}, {650, 950}, {700, 1000}, {300, 600}, 50},
+    {"WS2812B-V5", {220, 380}, {580, 1000}, {580, 1000}, {220, 420}, 280},
+    {"WS2813", {300, 450}, {750, 1000}, {300, 100000}, {300, 100000}, 300},
+    {"SK6812", {150, 450}, {450, 750}, {750, 1050}, {450, 750}, 80},
+    {"WS2811 400K", {350, 650}, {1050, 1350}, {1850, 2150}, {1150, 1450}, 50},
+};
+
+#define NEOPXL8_CHIP_SPECS                                                     \
+  (sizeof neopxl8_chip_specs / sizeof neopxl8_chip_specs[0]) ///< Table size
+
+// WAVEFORM MODEL ----------------------------------------------------------
+
+/*!
+  @brief  Timing of generated waveform. Fractional clock dividers make
+          phase durations vary by one source clock, so high and low times
+          are min/max pairs, in nanoseconds.
+*/
+typedef struct {
+  float t0h[2];    ///< '0' bit high time
+  float t1h[2];    ///< '1' bit high time
+  float t0l[2];    ///< '0' bit low time
+  float t1l[2];    ///< '1' bit low time
+  float period[2]; ///< Bit period
+  float reset;     ///< Minimum reset (latch) low time, microseconds
+} neopxl8_waveform_t;
+
+/*!
+  @brief  Bits set in result of neopxl8_timing_check() for each parameter
+          outside the chip's limits.
+*/
+enum {
+  NEOPXL8_TIMING_T0H = 0x01,   ///< '0' bit high time
+  NEOPXL8_TIMING_T1H = 0x02,   ///< '1' bit high time
+  NEOPXL8_TIMING_T0L = 0x04,   ///< '0' bit low time
+  NEOPXL8_TIMING_T1L = 0x08,   ///< '1' bit low time
+  NEOPXL8_TIMING_RESET = 0x10, ///< Reset (latch) time
+};
+
+// Duration of n output clocks, each 'div' source clocks, as min/max in ns.
+// A fractional divider (PIO, LCD_CAM) spreads the remainder across cycles
+// as it goes, so n cycles last either floor(n * div) or ceil(n * div)
+// source clocks.
+static inline void neopxl8_timing_span(float *t, float sourceHz, float div,
+                                       uint16_t n) {
+  float ns = 1000000000.0f / sourceHz;
+  t[0] = floorf(n * div + 0.0001f) * ns;
+  t[1] = ceilf(n * div - 0.0001f) * ns;
+}
+
+/*!
+  @brief  Compute bit timing from an output clock and phase durations.
+  @param  w         Waveform result. reset is not set.
+  @param  sourceHz  Source clock frequency, Hz.
+  @param  div       Effective divider from source to output clock, may be
+                    fractional.
+  @param  high      Output clocks in high phase.
+  @param  data      Output clocks in data phase.
+  @param  low       Output clocks in low phase.
+*/
+static inline void neopxl8_timing_bits(neopxl8_waveform_t *w, float sourceHz,
+                                       float div, uint8_t high, uint8_t data,
+                                       uint8_t low) {
+  neopxl8_timing_span(w->t0h, sourceHz, div, high);
+  neopxl8_timing_span(w->t1h, sourceHz, div, high + data);
+  neopxl8_timing_span(w->t0l, sourceHz, div, data + low);
+  neopxl8_timing_span(w->t1l, sourceHz, div, low);
+  neopxl8_timing_span(w->period, sourceHz, div, high + data + low);
+}
+
+// TIMING DESCRIPTORS ------------------------------------------------------
+
+/*!
+  @brief  Requested NeoPixel bit timing, passed to Adafruit_NeoPXL8 (or
+          NeoPXL8HDR) begin(). Times are in nanoseconds. The bit period is
+          matched closely on all platforms, high times as closely as each
+          platform allows:
+          - RP2040/RP2350: PIO program delays are regenerated to
+            approximate the T0H and T1H fractions of the period.
+          - SAMD and ESP32-S3: each bit is three equal DMA beats, so T0H
+            and T1H are always 1/3 and 2/3 of the period.
+          - SAMD51 with 16 or 32 lanes (PORT DMA): T0H, T1H and period
+            are each rounded to the nearest TCC1 clock (48 MHz).
+          neopxl8_timing_rp2040() etc. (or extras/neopxl8timing) show what
+          a descriptor actually produces.
+*/
+typedef struct {
+  uint16_t t0h;    ///< '0' bit high time
+  uint16_t t1h;    ///< '1' bit high time
+  uint16_t period; ///< Bit period (inverse of bit rate)
+} neopxl8_timing_t;
+
+/*!
+  800 KHz timing, for WS2812, SK6812 and most others. This is the default,
+  and yields the library's original 2/9 and 6/9 PIO duty cycles.
+*/
+static const neopxl8_timing_t neopxl8_timing_800k = {278, 833, 1250};
+
+/*!
+  400 KHz timing, for WS2811 in low-speed mode. On SAMD and ESP32-S3, high
+  times are 833 and 1667 ns, outside the WS2811 datasheet range.
+*/
+static const neopxl8_timing_t neopxl8_timing_400k = {500, 1200, 2500};
+
+/*!
+  @brief  RP2040/RP2350 PIO program settings for a timing descriptor.
+*/
+typedef struct {
+  uint8_t high; ///< PIO cycles in high phase, 1-32
+  uint8_t data; ///< PIO cycles in data phase, 1-32
+  uint8_t low;  ///< PIO cycles in low phase, 2-33 (includes 'pull')
+  float div;    ///< Clock divider, before 16.8 fixed-point rounding
+} neopxl8_pio_config_t;
+
+/*!
+  @brief  Find PIO program delays and clock divider for a timing
+          descriptor: the fewest PIO cycles per bit that best approximate
+          its T0H and T1H.
+  @param  c      Result.
+  @param  f_cpu  System clock, Hz.
+  @param  t      Requested timing.
+  @return true on success, false if timing can't be produced at this
+          clock (period too short, or T0H/T1H/period not in order).
+*/
+static inline bool neopxl8_pio_config(neopxl8_pio_config_t *c, uint32_t f_cpu,
+                                      const neopxl8_timing_t *t) {
+  c->high = c->data = c->low = 0;
+  c->div = 0.0f;
+  if (!t->t0h || (t->t1h <= t->t0h) || (t->period <= t->t1h))
+    return false;
+  float bestError = 1e9f;
+  for (uint8_t n = 4; n <= 97; n++) { // PIO cycles per bit
+    uint32_t high = (t->t0h * n + t->period / 2) / t->period;
+    uint32_t high1 = (t->t1h * n + t->period / 2) / t->period;
+    if (!high || (high > 32) || (high1 <= high) || (high1 - high > 32) ||
+        (n - high1 < 2) || (n - high1 > 33))
+      continue;
+    // Same expression as originally used in begin() for 800 KHz
+    float div = (float)f_cpu / (1000000000.0 / t->period) / n;
+    if ((div < 1.0f) || (div >= 65536.0f))
+      continue;
+    float error = (fabsf((float)high * t->period - (float)t->t0h * n) +
+                   fabsf((float)high1 * t->period - (float)t->t1h * n)) /
+                  n;
+    if (error < bestError - 1.0f) { // Longer program must be 1 ns better
+      bestError = error;
+      c->high = high;
+      c->data = high1 - high;
+      c->low = n - high1;
+      c->div = div;
+    }
+  }
+  return bestError < 1e9f;
+}
+
+/*!
+  @brief  Effective PIO clock divider, as rounded by sm_config_set_clkdiv()
+          to 16.8 fixed point.
+  @param  div  Requested divider.
+  @return Divider (system clocks per PIO cycle).
+*/
+static inline float neopxl8_pio_clkdiv(float div) {
+  uint16_t div_int = (uint16_t)div;
+  uint8_t div_frac = div_int ? (uint8_t)((div - (float)div_int) * 256) : 0;
+  return (float)div_int + (float)div_frac / 256.0f;
+}
+
+/*!
+  @brief  TCC0 period register value for a bit period.
+  @param  clock   TCC0 clock, Hz (48 MHz on SAMD51, F_CPU on SAMD21).
+  @param  period  Bit period, nanoseconds.
+  @return PER value; the pattern generator advances every PER+1 clocks,
+          three times per bit.
+*/
+static inline uint32_t neopxl8_tcc_period(uint32_t clock,
+                                          uint16_t period = 1250) {
+  if (!period)
+    return 0;
+  uint32_t beatHz = 3000000000UL / period; // 2.4 MHz at 800 KHz
+  uint32_t clocks = (clock + beatHz / 2) / beatHz;
+  return clocks ? clocks - 1 : 0;
+}
+
+/*!
+  @brief  Check a timing descriptor against the SAMD pattern generator.
+          Only the period is used; high times are always 1/3 and 2/3 of
+          it.
+  @param  clock  TCC0 clock, Hz (48 MHz on SAMD51, F_CPU on SAMD21).
+  @param  t      Requested timing.
+  @return true on success, false if the period is too short for DMA to
+          keep up (see NEOPXL8_TCC_MIN_PER).
+*/
+static inline bool neopxl8_tcc_config(uint32_t clock,
+                                      const neopxl8_timing_t *t) {
+  return neopxl8_tcc_period(clock, t->period) >= NEOPXL8_TCC_MIN_PER;
+}
+
+/*!
+  @brief  SAMD51 PORT DMA timer settings (16 or 32 lanes). Each bit period
+          is one TCC1 cycle. Three compare matches each trigger a DMA
+          write. CC0 sets the lanes with a '1' bit (data from the buffer).
+          CC1 sets all the other lanes. CC2 clears all lanes. A '1' stays
+          high for T1H and a '0' for T0H. The '0' bits rise later rather
+          than fall earlier, so the buffer holds plain data, not inverted
+          data.
+*/
+typedef struct {
+  uint32_t per;   ///< TCC PER value; bit period is PER+1 clocks
+  uint32_t cc[3]; ///< Compare values: set '1' lanes, set all, clear all
+} neopxl8_port_config_t;
+
+/*!
+  @brief  Find TCC1 period and compare values for a timing descriptor.
+  @param  c      Result.
+  @param  clock  TCC1 clock, Hz (48 MHz).
+  @param  t      Requested timing.
+  @return true on success, false if timing can't be produced at this
+          clock (high times don't fit in period, or not in order).
+*/
+static inline bool neopxl8_port_config(neopxl8_port_config_t *c,
+                                       uint32_t clock,
+                                       const neopxl8_timing_t *t) {
+  uint32_t t0h = ((uint64_t)clock * t->t0h + 500000000) / 1000000000;
+  uint32_t t1h = ((uint64_t)clock * t->t1h + 500000000) / 1000000000;
+  uint32_t per = ((uint64_t)clock * t->period + 500000000) / 1000000000;
+  c->per = per - 1;
+  c->cc[0] = NEOPXL8_PORT_LEAD;
+  c->cc[1] = NEOPXL8_PORT_LEAD + t1h - t0h;
+  c->cc[2] = NEOPXL8_PORT_LEAD + t1h;
+  return t0h && (t1h > t0h) && (c->cc[2] < c->per);
+}
+
+/*!
+  @brief  LCD_CAM clock divider for a bit period, as div_num + b / a.
+  @param  sourceHz  LCD_CAM clock source, Hz (PLL, 240 MHz).
+  @param  period    Bit period, nanoseconds.
+  @param  num       lcd_clkm_div_num result.
+  @param  a         lcd_clkm_div_a result.
+  @param  b         lcd_clkm_div_b result.
+*/
+static inline void neopxl8_lcd_divider(uint32_t sourceHz, uint16_t period,
+                                       uint16_t *num, uint8_t *a,
+                                       uint8_t *b) {
+  // Total divider in 63rds (largest fractional denominator)
+  uint32_t q = ((uint64_t)sourceHz * period * 63 + 1500000000) / 3000000000;
+  *num = q / 63;
+  *b = q % 63;
+  if (*b) {
+    *a = 63;
+  } else { // Whole number, expressed as (N-1) + 1/1 as originally in begin()
+    *num -= 1;
+    *a = *b = 1;
+  }
+}
+
+// PLATFORM MODELS ---------------------------------------------------------
+
+/*!
+  @brief  Model RP2040/RP2350 output.
+  @param  w          Waveform result.
+  @param  f_cpu      System clock, Hz.
+  @param  latchtime  setLatchTime() value, microseconds.
+  @param  t          Timing passed to begin().
+  @return true on success, false if timing not possible (see
+          neopxl8_pio_config()).
+*/
+static inline bool
+neopxl8_timing_rp2040(neopxl8_waveform_t *w, uint32_t f_cpu,
+                      uint16_t latchtime,
+                      const neopxl8_timing_t *t = &neopxl8_timing_800k) {
+  neopxl8_pio_config_t c;
+  if (!neopxl8_pio_config(&c, f_cpu, t))
+    return false;
+  neopxl8_timing_bits(w, f_cpu, neopxl8_pio_clkdiv(c.div), c.high, c.data,
+                      c.low);
+  // The latch interval is timed from the DMA IRQ, but a few bits are
+  // still queued in the PIO at that point; micros() granularity costs up
+  // to another microsecond.
+  w->reset = latchtime - NEOPXL8_PIO_QUEUE * w->period[1] / 1000.0f - 1.0f;
+  return true;
+}
+
+/*!
+  @brief  Model SAMD21/SAMD51 output.
+  @param  w          Waveform result.
+  @param  clock      TCC0 clock, Hz (48 MHz on SAMD51, F_CPU on SAMD21).
+  @param  latchtime  setLatchTime() value, microseconds.
+  @param  t          Timing passed to begin().
+  @return true on success, false if timing not possible (see
+          neopxl8_tcc_config()).
+*/
+static inline bool
+neopxl8_timing_samd(neopxl8_waveform_t *w, uint32_t clock, uint16_t latchtime,
+                    const neopxl8_timing_t *t = &neopxl8_timing_800k) {
+  if (!neopxl8_tcc_config(clock, t))
+    return false;
+  float beat = neopxl8_tcc_period(clock, t->period) + 1;
+  neopxl8_timing_bits(w, clock, beat, NEOPXL8_BEAT_HIGH, NEOPXL8_BEAT_DATA,
+                      NEOPXL8_BEAT_LOW);
+  // show() shortens the latch wait to allow for the lead-in zero bytes,
+  // which are then clocked out at the beat rate.
+  w->reset = latchtime - NEOPXL8_SAMD_LEADIN_US +
+             NEOPXL8_SAMD_LEADIN * beat * 1000000.0f / clock - 1.0f;
+  return true;
+}
+
+/*!
+  @brief  Model SAMD51 PORT DMA output (16 or 32 lanes). DMA latency after
+          each compare match is not included. It is about the same for
+          all three writes, so it mostly cancels out.
+  @param  w          Waveform result.
+  @param  clock      TCC1 clock, Hz (48 MHz).
+  @param  latchtime  setLatchTime() value, microseconds.
+  @param  t          Timing passed to begin().
+  @return true on success, false if timing not possible (see
+          neopxl8_port_config()).
+*/
+static inline bool
+neopxl8_timing_samd_port(neopxl8_waveform_t *w, uint32_t clock,
+                         uint16_t latchtime,
+                         const neopxl8_timing_t *t = &neopxl8_timing_800k) {
+  neopxl8_port_config_t c;
+  if (!neopxl8_port_config(&c, clock, t))
+    return false;
+  uint32_t per = c.per + 1;
+  neopxl8_timing_span(w->t0h, clock, 1.0f, c.cc[2] - c.cc[1]);
+  neopxl8_timing_span(w->t1h, clock, 1.0f, c.cc[2] - c.cc[0]);
+  neopxl8_timing_span(w->t0l, clock, 1.0f, per - (c.cc[2] - c.cc[1]));
+  neopxl8_timing_span(w->t1l, clock, 1.0f, per - (c.cc[2] - c.cc[0]));
+  neopxl8_timing_span(w->period, clock, 1.0f, per);
+  // The transfer completes on the first compare match after the last bit
+  w->reset = latchtime - 1.0f;
+  return true;
+}
+
+/*!
+  @brief  Model ESP32-S3 output.
+  @param  w          Waveform result.
+  @param  sourceHz   LCD_CAM clock source, Hz (PLL, 240 MHz).
+  @param  latchtime  setLatchTime() value, microseconds.
+  @param  t          Timing passed to begin().
+*/
+static inline void
+neopxl8_timing_esp32s3(neopxl8_waveform_t *w, uint32_t sourceHz,
+                       uint16_t latchtime,
+                       const neopxl8_timing_t *t = &neopxl8_timing_800k) {
+  uint16_t num;
+  uint8_t a, b;
+  neopxl8_lcd_divider(sourceHz, t->period, &num, &a, &b);
+  neopxl8_timing_bits(w, sourceHz, num + (float)b / a, NEOPXL8_BEAT_HIGH,
+                      NEOPXL8_BEAT_DATA, NEOPXL8_BEAT_LOW);
+  // Latch is timed from when show() sees the transfer has finished
+  w->reset = latchtime - 1.0f;
+}
+
+/*!
+  @brief  Check modeled waveform against a chip's datasheet limits.
+  @param  w     Waveform, from one of the neopxl8_timing_*() functions.
+  @param  spec  Chip specification, e.g. from neopxl8_chip_specs[].
+  @return 0 if all within limits, else NEOPXL8_TIMING_* bits for each
+          parameter outside.
+*/
+static inline uint8_t neopxl8_timing_check(const neopxl8_waveform_t *w,
+                                           const neopxl8_chip_spec_t *spec) {
+  uint8_t result = 0;
+  if ((w->t0h[0] < spec->t0h[0]) || (w->t0h[1] > spec->t0h[1]))
+    result |= NEOPXL8_TIMING_T0H;
+  if ((w->t1h[0] < spec->t1h[0]) || (w->t1h[1] > spec->t1h[1]))
+    result |= NEOPXL8_TIMING_T1H;
+  if ((w->t0l[0] < spec->t0l[0]) || (w->t0l[1] > spec->t0l[1]))
+    result |= NEOPXL8_TIMING_T0L;
+  if ((w->t1l[0] < spec->t1l[0]) || (w->t1l[1] > spec->t1l[1]))
+    result |= NEOPXL8_TIMING_T1L;
+  if (w->reset < spec->reset)
+    result |= NEOPXL8_TIMING_RESET;
+  return result;
+}
+
+#endif // _ADAFRUIT_NEOPXL8TIMING_H_
@@ -0,0 +1,1081 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * @file Adafruit_NeoPXL8Video.h
+ *
+ * Video file format for Adafruit_NeoPXL8, and a player for such files.
+ * Frames are converted once on a host computer by extras/neopxl8video,
+ * either to a pre-transposed form streamed straight into the NeoPXL8 DMA
+ * buffer (playback CPU load is little more than the file read, regardless
+ * of pixel count), or to a compressed RGB form (keyframes plus deltas)
+ * that minimizes flash reads, decoded into an external framebuffer.
+ *
+ * The format definitions have no Arduino dependencies and are shared with
+ * the host encoder. The player is compiled only in Arduino builds.
+ *
+ * Adafruit invests time and resources providing this open source code,
+ * please support Adafruit and open-source hardware by purchasing
+ * products from Adafruit!
+ *
+ * MIT license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef _ADAFRUIT_NEOPXL8VIDEO_H_
+#define _ADAFRUIT_NEOPXL8VIDEO_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// FILE FORMAT -------------------------------------------------------------
+
+// All multi-byte values are little-endian, matching every supported chip.
+// A file is one neopxl8_video_header_t followed by frameCount frames. Each
+// frame is a neopxl8_video_frame_t record and 'size' bytes of payload. If
+// header 'align' is nonzero, the encoder pads before each frame record so
+// the payload that follows starts on an 'align'-byte file boundary, which
+// lets SdFat read whole sectors directly into the DMA buffer.
+
+#define NEOPXL8_VIDEO_MAGIC "NPX8" ///< First 4 bytes of file
+#define NEOPXL8_VIDEO_VERSION 1    ///< Format version in header
+
+// Payload layouts (header 'layout' field)
+#define NEOPXL8_VIDEO_RGB 0    ///< RGB image for setFrameBuffer(), see below
+#define NEOPXL8_VIDEO_PLANES 1 ///< DMA-ready bit planes, see below
+
+// Frame record types (frame 'type' field)
+#define NEOPXL8_FRAME_RAW 0   ///< Payload is a complete frame
+#define NEOPXL8_FRAME_KEY 1   ///< Ops (see below) applied to a cleared frame
+#define NEOPXL8_FRAME_DELTA 2 ///< Ops applied to the previous frame
+
+// NEOPXL8_VIDEO_PLANES payload is the RP2040 DMA buffer layout, which is
+// also the data byte of each SAMD/ESP32S3 high/data/low triplet: one byte
+// per NeoPixel bit, MSB first, one bit per strand (bit 0 = strand 0, etc.),
+// strand pixels in wire color order. Brightness and gamma are applied by
+// the encoder. Frame size is strandLength * bytesPerPixel * 8 bytes. Only
+// NEOPXL8_FRAME_RAW frames are allowed.
+
+// NEOPXL8_VIDEO_RGB payload is a width * height RGB image, row-major, gamma
+// and brightness applied by the encoder. The player passes header layout
+// fields to setLayout() and the image to setFrameBuffer(), so the library
+// handles pixel order and color order. Frames may be any type.
+
+// NEOPXL8_FRAME_KEY and NEOPXL8_FRAME_DELTA payloads are a sequence of ops
+// that together cover the whole frame. Each op is one byte: type in the
+// upper two bits, count - 1 in the lower six. If those six bits are all
+// set, a little-endian base-128 varint follows (7 bits per byte, high bit
+// set if more bytes follow) and is added to the count - 1 value.
+#define NEOPXL8_OP_SKIP 0x00  ///< Leave count bytes as-is (0 in a keyframe)
+#define NEOPXL8_OP_COPY 0x40  ///< count literal bytes follow
+#define NEOPXL8_OP_FILL 0x80  ///< One pixel follows, repeat it count times
+#define NEOPXL8_OP_TYPE 0xC0  ///< Mask for op type bits
+#define NEOPXL8_OP_COUNT 0x3F ///< Mask for op count bits
+
+/*!
+  @brief  NeoPXL8 video file header, 32 bytes.
+*/
+typedef struct __attribute__((packed)) {
+  char magic[4];         ///< NEOPXL8_VIDEO_MAGIC (not NUL-terminated)
+  uint8_t version;       ///< NEOPXL8_VIDEO_VERSION
+  uint8_t layout;        ///< Payload layout, e.g. NEOPXL8_VIDEO_PLANES
+  uint8_t bytesPerPixel; ///< 3 (RGB) or 4 (RGBW), always 3 for VIDEO_RGB
+  uint8_t lanes;         ///< Parallel outputs, always 8 for now
+  uint16_t strandLength; ///< Pixels per output
+  uint16_t width;        ///< Source image width (informational)
+  uint16_t height;       ///< Source image height (informational)
+  uint16_t align;        ///< Payload file alignment, 0 = none
+  uint32_t frameBytes;   ///< Bytes in one complete frame payload
+  uint32_t frameCount;   ///< Number of frames in file
+  uint32_t frameUsec;    ///< Nominal frame interval, microseconds
+  uint8_t matrixLayout;  ///< setLayout() layout, NEOPXL8_VIDEO_RGB only
+  uint8_t rotation;      ///< setLayout() rotation, NEOPXL8_VIDEO_RGB only
+  uint8_t tilesAcross;   ///< setLayout() tilesAcross, 0 is same as 1
+  uint8_t tilesDown;     ///< setLayout() tilesDown, 0 is same as 1
+} neopxl8_video_header_t;
+
+/*!
+  @brief  NeoPXL8 video frame record, 12 bytes, precedes each payload.
+*/
+typedef struct __attribute__((packed)) {
+  uint8_t type;        ///< Frame type, e.g. NEOPXL8_FRAME_RAW
+  uint8_t reserved[3]; ///< Set to 0
+  uint32_t usec;       ///< Display this long after previous frame
+  uint32_t size;       ///< Payload bytes following this record
+} neopxl8_video_frame_t;
+
+/*!
+  @brief   Get file position of a frame record, given the position just
+           past the previous frame's payload (or the header).
+  @param   pos    File position following prior data.
+  @param   align  Header 'align' value.
+  @return  File position of next frame record.
+*/
+static inline uint32_t neopxl8_video_record_pos(uint32_t pos, uint16_t align) {
+  if (align > 1) {
+    pos += sizeof(neopxl8_video_frame_t) + align - 1;
+    pos -= pos % align;
+    pos -= sizeof(neopxl8_video_frame_t);
+  }
+  return pos;
+}
+
+// FRAME CODEC -------------------------------------------------------------
+
+// Encoding and decoding of NEOPXL8_FRAME_KEY and NEOPXL8_FRAME_DELTA op
+// sequences, shared by the file player, stream receiver and host tools.
+
+/*!
+  @brief  Byte source for neopxl8_decode(), reading from memory. Other
+          sources (e.g. files) provide the same three functions.
+*/
+struct neopxl8_mem_source {
+  const uint8_t *ptr; ///< Next byte to read
+  const uint8_t *end; ///< End of data
+  /*!
+    @brief  Fetch next byte.
+    @param  b  Pointer to result.
+    @return true on success, false if no more data.
+  */
+  bool next(uint8_t *b) {
+    if (ptr >= end)
+      return false;
+    *b = *ptr++;
+    return true;
+  }
+  /*!
+    @brief  Copy next n bytes.
+    @param  dst  Destination.
+    @param  n    Number of bytes.
+    @return true on success, false if not enough data.
+  */
+  bool copy(uint8_t *dst, uint32_t n) {
+    if (n > (uint32_t)(end - ptr))
+      return false;
+    memcpy(dst, ptr, n);
+    ptr += n;
+    return true;
+  }
+  /*!
+    @brief  Check for end of data.
+    @return true if all data has been read.
+  */
+  bool done(void) const { return ptr >= end; }
+};
+
+/*!
+  @brief   Apply a NEOPXL8_FRAME_KEY or NEOPXL8_FRAME_DELTA op sequence to a
+           frame (for keyframes, clear the frame first). Pixels are 3 bytes.
+  @param   src  Byte source, e.g. neopxl8_mem_source.
+  @param   dst  Frame to modify.
+  @param   len  Size of frame in bytes.
+  @return  true on success, false if data is malformed or does not cover
+           the whole frame (frame contents are then undefined).
+*/
+template <class Source>
+bool neopxl8_decode(Source &src, uint8_t *dst, uint32_t len) {
+  uint8_t *end = dst + len, op, b, pixel[3];
+  while (!src.done()) {
+    if (!src.next(&op))
+      return false;
+    uint32_t count = op & NEOPXL8_OP_COUNT;
+    if (count == NEOPXL8_OP_COUNT) { // Varint extension follows
+      uint8_t shift = 0;
+      do {
+        if ((shift > 21) || !src.next(&b))
+          return false;
+        count += (uint32_t)(b & 0x7F) << shift;
+        shift += 7;
+      } while (b & 0x80);
+    }
+    count++;
+    uint32_t room = end - dst;
+    switch (op & NEOPXL8_OP_TYPE) {
+    case NEOPXL8_OP_SKIP:
+      if (count > room)
+        return false;
+      dst += count;
+      break;
+    case NEOPXL8_OP_COPY:
+      if ((count > room) || !src.copy(dst, count))
+        return false;
+      dst += count;
+      break;
+    case NEOPXL8_OP_FILL:
+      if ((count > room / 3) || !src.next(&pixel[0]) || !src.next(&pixel[1]) ||
+          !src.next(&pixel[2]))
+        return false;
+      while (count--) {
+        *dst++ = pixel[0];
+        *dst++ = pixel[1];
+        *dst++ = pixel[2];
+      }
+      break;
+    default:
+      return false;
+    }
+  }
+  return dst == end;
+}
+
+// Append one op to compressed output, return new length or 0 if no room
+static inline uint32_t neopxl8_put_op(uint8_t *out, uint32_t len,
+                                      uint32_t max, uint8_t type,
+                                      uint32_t count) {
+  count--;
+  if (len >= max)
+    return 0;
+  if (count < NEOPXL8_OP_COUNT) {
+    out[len++] = type | count;
+    return len;
+  }
+  out[len++] = type | NEOPXL8_OP_COUNT;
+  count -= NEOPXL8_OP_COUNT;
+  do {
+    if (len >= max)
+      return 0;
+    uint8_t b = count & 0x7F;
+    if (count >>= 7)
+      b |= 0x80;
+    out[len++] = b;
+  } while (count);
+  return len;
+}
+
+/*!
+  @brief   Compress an RGB frame as NEOPXL8_FRAME_KEY or NEOPXL8_FRAME_DELTA
+           ops. Unchanged pixels are skipped, runs of 3+ same-color pixels
+           are filled, and anything else is copied literally.
+  @param   cur        Frame to compress, 3 bytes per pixel.
+  @param   prev       Previous frame for a delta, or all zeros for a
+                      keyframe.
+  @param   numPixels  Pixel count.
+  @param   out        Output buffer.
+  @param   max        Size of output buffer. Using the uncompressed frame
+                      size here ensures compression is worthwhile.
+  @return  Compressed size in bytes, or 0 if it would exceed max.
+*/
+static inline uint32_t neopxl8_compress(const uint8_t *cur,
+                                        const uint8_t *prev,
+                                        uint32_t numPixels, uint8_t *out,
+                                        uint32_t max) {
+  uint32_t i = 0, n, len = 0;
+  while (i < numPixels) {
+    const uint8_t *c = &cur[i * 3];
+    for (n = 0;
+         (i + n < numPixels) && !memcmp(&c[n * 3], &prev[(i + n) * 3], 3); n++)
+      ;
+    if (n) {
+      if (!(len = neopxl8_put_op(out, len, max, NEOPXL8_OP_SKIP, n * 3)))
+        return 0;
+      i += n;
+      continue;
+    }
+    for (n = 1; (i + n < numPixels) && !memcmp(&c[n * 3], c, 3); n++)
+      ;
+    if (n >= 3) {
+      if (!(len = neopxl8_put_op(out, len, max, NEOPXL8_OP_FILL, n)) ||
+          (len + 3 > max))
+        return 0;
+      memcpy(&out[len], c, 3);
+      len += 3;
+      i += n;
+      continue;
+    }
+    // Literal run ends where a skip or fill would begin
+    uint32_t start = i;
+    for (i++; i < numPixels; i++) {
+      const uint8_t *p = &cur[i * 3];
+      if (!memcmp(p, &prev[i * 3], 3) ||
+          ((i + 2 < numPixels) && !memcmp(p, p + 3, 3) && !memcmp(p, p + 6, 3)))
+        break;
+    }
+    n = (i - start) * 3;
+    if (!(len = neopxl8_put_op(out, len, max, NEOPXL8_OP_COPY, n)) ||
+        (len + n > max))
+      return 0;
+    memcpy(&out[len], c, n);
+    len += n;
+  }
+  return len;
+}
+
+/*!
+  @brief   Update a CRC-32 (IEEE 802.3, as used by zlib) with more data.
+           Uses a 16-entry table, a compromise between speed and size.
+  @param   crc   0 to start, or result of a prior call.
+  @param   data  Data to add.
+  @param   len   Length of data in bytes.
+  @return  Updated CRC-32.
+*/
+static inline uint32_t neopxl8_crc32(uint32_t crc, const uint8_t *data,
+                                     uint32_t len) {
+  static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ table[crc & 15];
+    crc = (crc >> 4) ^ table[crc & 15];
+  }
+  return ~crc;
+}
+
+// STREAM PROTOCOL ---------------------------------------------------------
+
+// For sending frames over a serial link (e.g. USB CDC), see VideoSerial
+// example and extras/neopxl8send. Each packet is a neopxl8_stream_header_t,
+// 'size' bytes of payload (RAW, KEY or DELTA frame data, as in files with
+// the NEOPXL8_VIDEO_RGB layout), then a little-endian CRC-32 of everything
+// after the sync bytes (header version through end of payload). Packets
+// with a bad CRC, and any deltas following them, are dropped until the
+// next RAW or KEY frame. The receiver may send NEOPXL8_STREAM_NAK back to
+// the sender to ask for one right away.
+
+#define NEOPXL8_STREAM_SYNC0 0xA5  ///< First byte of each packet
+#define NEOPXL8_STREAM_SYNC1 0x58  ///< Second byte of each packet
+#define NEOPXL8_STREAM_VERSION 1   ///< Protocol version in header
+#define NEOPXL8_STREAM_NAK 0x15    ///< Receiver to sender: need keyframe
+
+/*!
+  @brief  NeoPXL8 stream packet header, 14 bytes.
+*/
+typedef struct __attribute__((packed)) {
+  uint8_t sync[2];  ///< NEOPXL8_STREAM_SYNC0, NEOPXL8_STREAM_SYNC1
+  uint8_t version;  ///< NEOPXL8_STREAM_VERSION
+  uint8_t type;     ///< Frame type, e.g. NEOPXL8_FRAME_DELTA
+  uint8_t seq;      ///< Sequence number, +1 (mod 256) each packet
+  uint8_t reserved; ///< Set to 0
+  uint32_t usec;    ///< Display this long after previous frame, 0 = now
+  uint32_t size;    ///< Payload bytes following this header
+} neopxl8_stream_header_t;
+
+/*!
+  @brief  Incremental stream packet parser. Bytes are fed in as they
+          arrive, in any size pieces; whole packets are verified into a
+          packet slot, then decoded into an RGB framebuffer (e.g. one
+          passed to Adafruit_NeoPXL8::setFrameBuffer()) by available().
+          With two slots, the next packet can be received (e.g. from a
+          USB interrupt or callback) while the prior one is decoded and
+          shown. Has no Arduino dependencies so it can also run on a host
+          computer.
+*/
+class Adafruit_NeoPXL8Receiver {
+public:
+  /*!
+    @brief  Receiver constructor.
+    @param  frame       RGB framebuffer, 3 bytes per pixel.
+    @param  frameBytes  Size of framebuffer in bytes.
+    @param  packet      Buffer for incoming payload, at least frameBytes
+                        (senders use RAW frames if compression would be
+                        larger).
+    @param  packetMax   Size of packet buffer(s) in bytes.
+    @param  packet2     Optional second packet buffer, same size, for
+                        receiving one packet while another is decoded.
+  */
+  Adafruit_NeoPXL8Receiver(uint8_t *frame, uint32_t frameBytes,
+                           uint8_t *packet, uint32_t packetMax,
+                           uint8_t *packet2 = NULL)
+      : frame(frame), frame_bytes(frameBytes), packet_max(packetMax),
+        slot_mask(packet2 ? 1 : 0) {
+    slot[0] = packet;
+    slot[1] = packet2;
+  }
+
+  /*!
+    @brief  Process incoming bytes. Stops when all packet slots hold
+            verified packets not yet decoded by available(); with a single
+            slot, that's just after each packet.
+    @param  data  Incoming bytes.
+    @param  len   Number of bytes.
+    @return Number of bytes consumed, from 0 to len.
+  */
+  uint32_t feed(const uint8_t *data, uint32_t len) {
+    uint32_t i = 0;
+    while ((i < len) && !full[fill]) {
+      if (state == 3) { // Payload; copy as much as available at once
+        uint32_t n = header.size - count;
+        if (n > len - i)
+          n = len - i;
+        memcpy(&slot[fill][count], &data[i], n);
+        written(n);
+        i += n;
+        continue;
+      }
+      uint8_t b = data[i++];
+      switch (state) {
+      case 0: // Sync byte 0
+        if (b == NEOPXL8_STREAM_SYNC0)
+          state = 1;
+        break;
+      case 1: // Sync byte 1 (or another sync byte 0, keep waiting)
+        if (b == NEOPXL8_STREAM_SYNC1) {
+          count = 2; // Header bytes follow sync
+          state = 2;
+        } else if (b != NEOPXL8_STREAM_SYNC0) {
+          state = 0;
+        }
+        break;
+      case 2: // Rest of header
+        ((uint8_t *)&header)[count++] = b;
+        if (count == sizeof header) {
+          if ((header.version != NEOPXL8_STREAM_VERSION) ||
+              (header.size > packet_max)) {
+            state = 0; // Not a packet (or not for us), resync
+            stat_errors++;
+          } else {
+            crc = neopxl8_crc32(0, &((uint8_t *)&header)[2], count - 2);
+            count = 0;
+            state = header.size ? 3 : 4;
+          }
+        }
+        break;
+      default: // CRC
+        rx_crc |= (uint32_t)b << (count * 8);
+        if (++count == 4) {
+          receive(rx_crc == crc);
+          rx_crc = 0;
+          state = 0;
+        }
+        break;
+      }
+    }
+    return i;
+  }
+
+  /*!
+    @brief  For zero-copy receive: get location and size of the payload
+            bytes expected next, so a driver can read them directly into
+            the packet slot, then call written(). Between payloads (header
+            and CRC bytes), use feed().
+    @param  len  Receives maximum bytes that may be written.
+    @return Pointer into packet slot, or NULL if not receiving a payload
+            (or no slot is free).
+  */
+  uint8_t *getWriteBuffer(uint32_t *len) {
+    if ((state != 3) || full[fill])
+      return NULL;
+    *len = header.size - count;
+    return &slot[fill][count];
+  }
+
+  /*!
+    @brief  Account for payload bytes placed by getWriteBuffer() caller.
+    @param  len  Number of bytes written, no more than getWriteBuffer()
+                 allowed.
+  */
+  void written(uint32_t len) {
+    crc = neopxl8_crc32(crc, &slot[fill][count], len);
+    if ((count += len) == header.size) {
+      count = 0;
+      state = 4;
+    }
+  }
+
+  /*!
+    @brief  Decode the next verified packet, if any, into the framebuffer.
+            Packets that can't be shown (e.g. deltas after a lost packet)
+            are discarded.
+    @param  usec  If non-NULL, receives the frame's display interval.
+    @return true if framebuffer holds a new frame since the last call.
+  */
+  bool available(uint32_t *usec = NULL) {
+    while (full[next]) {
+      __sync_synchronize(); // Reading full flag before slot contents
+      if (gap[next])
+        have_key = false; // Frame is stale, deltas don't apply
+      bool ok = decode(slot_header[next], slot[next]);
+      if (ok && usec)
+        *usec = slot_header[next].usec;
+      __sync_synchronize(); // Done with slot contents before freeing
+      full[next] = false;
+      next = (next + 1) & slot_mask;
+      if (ok)
+        return true;
+    }
+    return false;
+  }
+
+  /*!
+    @brief  Check (and clear) whether a keyframe should be requested from
+            the sender, i.e. a packet was lost since the last call. If so,
+            send NEOPXL8_STREAM_NAK back to the sender.
+    @return true if keyframe needed.
+  */
+  bool nak(void) {
+    bool n = nak_pending;
+    nak_pending = false;
+    return n;
+  }
+
+  /*!
+    @brief  Check whether the parser is between packets, e.g. to share a
+            serial link with another protocol.
+    @return true if not partway through a packet.
+  */
+  bool idle(void) const { return state == 0; }
+
+  /*!
+    @brief  Inform the receiver that the framebuffer was changed by other
+            code, so deltas are ignored until the next keyframe.
+  */
+  void reset(void) { have_key = false; }
+
+  /*!
+    @brief  Count of frames decoded.
+    @return Frame count.
+  */
+  uint32_t getFrames(void) const { return stat_frames; }
+
+  /*!
+    @brief  Count of bad or lost packets (CRC errors, invalid headers,
+            sequence gaps and undecodable payloads).
+    @return Error count.
+  */
+  uint32_t getErrors(void) const { return stat_errors; }
+
+private:
+  // Handle complete packet: if good, hand slot over to available(),
+  // noting whether any packets were lost since the prior one.
+  void receive(bool crcOK) {
+    if (!crcOK) {
+      stat_errors++;
+      lost = nak_pending = true;
+      return;
+    }
+    if (have_seq && (header.seq != (uint8_t)(seq + 1))) {
+      stat_errors++; // Missed packet(s), maybe with bad header
+      lost = true;
+    }
+    seq = header.seq;
+    have_seq = true;
+    slot_header[fill] = header;
+    gap[fill] = lost;
+    lost = false;
+    __sync_synchronize(); // Slot contents before full flag
+    full[fill] = true;
+    fill = (fill + 1) & slot_mask;
+  }
+
+  // Decode packet into framebuffer, return true if frame is valid
+  bool decode(const neopxl8_stream_header_t &h, const uint8_t *data) {
+    bool ok = false;
+    neopxl8_mem_source src = {data, data + h.size};
+    switch (h.type) {
+    case NEOPXL8_FRAME_RAW:
+      if ((ok = (h.size == frame_bytes)))
+        memcpy(frame, data, frame_bytes);
+      break;
+    case NEOPXL8_FRAME_KEY:
+      memset(frame, 0, frame_bytes);
+      ok = neopxl8_decode(src, frame, frame_bytes);
+      break;
+    case NEOPXL8_FRAME_DELTA:
+      if (!have_key) {
+        nak_pending = true; // Wait for (and request) next keyframe
+        return false;
+      }
+      ok = neopxl8_decode(src, frame, frame_bytes);
+      break;
+    default:
+      return false; // Unknown type, ignore
+    }
+    if (ok) {
+      stat_frames++;
+    } else {
+      stat_errors++;
+      nak_pending = true;
+    }
+    have_key = ok;
+    return ok;
+  }
+
+  // Used by feed() (receiving side)
+  uint8_t *frame;                 ///< RGB framebuffer
+  uint8_t *slot[2];               ///< Payload buffers
+  uint32_t frame_bytes;           ///< Size of framebuffer
+  uint32_t packet_max;            ///< Size of each payload buffer
+  neopxl8_stream_header_t header; ///< Current packet header
+  uint32_t count = 0;             ///< Bytes received in current state
+  uint32_t crc = 0;               ///< CRC calculated over packet so far
+  uint32_t rx_crc = 0;            ///< CRC received at end of packet
+  uint8_t state = 0;              ///< Parser state
+  uint8_t seq = 0;                ///< Sequence number of last packet
+  uint8_t fill = 0;               ///< Slot being received
+  const uint8_t slot_mask;        ///< 1 if two slots, else 0
+  bool have_seq = false;          ///< If set, seq is valid
+  bool lost = false;              ///< If set, packet lost since last good
+  // Shared with available() (decoding side)
+  neopxl8_stream_header_t slot_header[2]; ///< Header for each slot
+  volatile bool full[2] = {false, false}; ///< Slot holds verified packet
+  bool gap[2];                            ///< Packet(s) lost before slot
+  uint8_t next = 0;                       ///< Next slot to decode
+  uint32_t stat_frames = 0;               ///< Frames decoded
+  uint32_t stat_errors = 0;               ///< Bad or lost packets
+  bool have_key = false;                  ///< If set, frame is valid for deltas
+  bool nak_pending = false;               ///< If set, keyframe request due
+};
+
+// PLAYER ------------------------------------------------------------------
+
+#if defined(ARDUINO)
+
+#include <Adafruit_NeoPXL8.h>
+
+/*!
+  @brief  Byte source for neopxl8_decode(), reading a compressed payload
+          from a file in chunks. File_t is as for Adafruit_NeoPXL8Player.
+*/
+template <class File_t> struct neopxl8_file_source {
+  /*!
+    @brief  Start reading a payload at the current file position.
+    @param  f     File.
+    @param  size  Payload size in bytes.
+  */
+  void begin(File_t *f, uint32_t size) {
+    file = f;
+    remain = size;
+    pos = len = 0;
+  }
+  /*!
+    @brief  Fetch next byte.
+    @param  b  Pointer to result.
+    @return true on success, false if no more data or read error.
+  */
+  bool next(uint8_t *b) {
+    if ((pos >= len) && !refill())
+      return false;
+    *b = buf[pos++];
+    return true;
+  }
+  /*!
+    @brief  Copy next n bytes.
+    @param  dst  Destination.
+    @param  n    Number of bytes.
+    @return true on success, false if not enough data or read error.
+  */
+  bool copy(uint8_t *dst, uint32_t n) {
+    while (n) {
+      if ((pos >= len) && !refill())
+        return false;
+      uint32_t c = len - pos;
+      if (c > n)
+        c = n;
+      memcpy(dst, &buf[pos], c);
+      dst += c;
+      pos += c;
+      n -= c;
+    }
+    return true;
+  }
+  /*!
+    @brief  Check for end of payload.
+    @return true if all data has been read.
+  */
+  bool done(void) const { return (pos >= len) && !remain; }
+
+private:
+  // Load next chunk of payload into buf
+  bool refill(void) {
+    if (!remain)
+      return false;
+    len = (remain < sizeof buf) ? remain : sizeof buf;
+    if (file->read(buf, len) != (int)len)
+      return false;
+    remain -= len;
+    pos = 0;
+    return true;
+  }
+  File_t *file = NULL; ///< Source file
+  uint32_t remain = 0; ///< Payload bytes not yet read into buf
+  uint16_t pos = 0;    ///< Next byte index in buf
+  uint16_t len = 0;    ///< Valid bytes in buf
+  uint8_t buf[256];    ///< Read buffer
+};
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <hardware/regs/addressmap.h>
+
+/*!
+  @brief  Locate a file's data in memory-mapped (XIP) flash, for use with
+          Adafruit_NeoPXL8Player::begin(data, size). RP2040 and RP2350
+          map all of QSPI flash into the address space, so a file stored
+          in one contiguous run of sectors on a flash filesystem (usual
+          for files copied to a freshly-formatted drive) can be read in
+          place. The address returned is in the XIP alias that bypasses
+          the cache, so video streaming doesn't evict program code.
+  @param  f       Open file. File_t is an SdFat-style class with
+                  contiguousRange(), fileSize(), seekSet() and read()
+                  functions, e.g. FatFile.
+  @param  fsBase  Address at which the filesystem's first sector appears
+                  in flash (in the XIP_BASE region).
+  @return Pointer to file data, or NULL if the file is fragmented or its
+          data is not at the expected address.
+*/
+template <class File_t>
+const uint8_t *neopxl8_xip_map(File_t *f, const uint8_t *fsBase) {
+  uint32_t first, last;
+  if (!f->contiguousRange(&first, &last))
+    return NULL;
+  // FAT sectors are 512 bytes
+  const uint8_t *data =
+      (const uint8_t *)((uintptr_t)fsBase + first * 512 - XIP_BASE +
+                        XIP_NOCACHE_NOALLOC_BASE);
+  // Confirm by comparing the start of the file, as read normally
+  uint8_t buf[64];
+  uint32_t n = (f->fileSize() < sizeof buf) ? f->fileSize() : sizeof buf;
+  if (!f->seekSet(0) || (f->read(buf, n) != (int)n) || memcmp(buf, data, n))
+    return NULL;
+  return data;
+}
+
+#endif // ARDUINO_ARCH_RP2040
+
+/*!
+  @brief  Plays NeoPXL8 video files. NEOPXL8_VIDEO_PLANES frames are read
+          directly into the Adafruit_NeoPXL8 DMA buffer. NEOPXL8_VIDEO_RGB
+          frames are decoded into a framebuffer which the NeoPXL8 object
+          then stages from; compressed frames only write the bytes that
+          change. File_t is any file class with SdFat-style read(buf, len)
+          and seekSet(pos) functions, e.g. FatFile or File32. Alternately,
+          a file may be played from memory (e.g. flash mapped into the
+          address space, see neopxl8_xip_map()); uncompressed RGB frames
+          are then staged in place, with no framebuffer copy. Not for use
+          with Adafruit_NeoPXL8HDR, which does its own staging.
+*/
+template <class File_t> class Adafruit_NeoPXL8Player {
+public:
+  /*!
+    @brief  Player constructor.
+    @param  leds  Adafruit_NeoPXL8 object, which must have begin()'d
+                  successfully before calling the player's begin().
+  */
+  Adafruit_NeoPXL8Player(Adafruit_NeoPXL8 &leds) : leds(leds) {}
+
+  /*!
+    @brief  Player destructor. Frees the framebuffer if allocated by the
+            player and detaches it from the NeoPXL8 object.
+  */
+  ~Adafruit_NeoPXL8Player() { end(); }
+
+  /*!
+    @brief  Validate a video file's header against the NeoPXL8 object and
+            prepare for playback from the first frame. For NEOPXL8_VIDEO_RGB
+            files, this also calls setLayout() and setFrameBuffer() on the
+            NeoPXL8 object.
+    @param  f    Pointer to open file, which must remain open while playing.
+    @param  buf  NEOPXL8_VIDEO_RGB only: framebuffer of header frameBytes
+                 (width * height * 3) bytes, or NULL (default) to have the
+                 player allocate one. Ignored for NEOPXL8_VIDEO_PLANES.
+    @return true on success, false if file is invalid, does not match the
+            NeoPXL8 strand length and color format, or on allocation error.
+  */
+  bool begin(File_t *f, uint8_t *buf = NULL) {
+    end();
+    file = f;
+    return init(buf);
+  }
+
+  /*!
+    @brief  As above, but play a video file image in memory. This is read
+            directly, with no file system overhead, and uncompressed
+            NEOPXL8_VIDEO_RGB frames are staged from it in place.
+    @param  data  Start of file data, which must remain valid while
+                  playing.
+    @param  size  File size in bytes.
+    @param  buf   NEOPXL8_VIDEO_RGB only: framebuffer as above, or NULL
+                  (default) to have the player allocate one. A framebuffer
+                  is only needed (and allocated) if the file contains
+                  compressed frames.
+    @return true on success, false on invalid file or allocation error.
+  */
+  bool begin(const uint8_t *data, uint32_t size, uint8_t *buf = NULL) {
+    end();
+    map = data;
+    mapSize = size;
+    return init(buf);
+  }
+
+  /*!
+    @brief  Stop playback. For NEOPXL8_VIDEO_RGB files, the NeoPXL8 object
+            returns to using its own pixel buffer, and the framebuffer is
+            freed if the player allocated it.
+  */
+  void end(void) {
+    if (rgb) {
+      leds.setFrameBuffer(NULL);
+      leds.clearLayout();
+      if (ownBuf)
+        free(frameBuf);
+    }
+    frameBuf = NULL;
+    shown = NULL;
+    ownBuf = rgb = ready = false;
+    file = NULL;
+    map = NULL;
+  }
+
+  /*!
+    @brief  Restart playback from the first frame.
+    @return true on success, false if begin() did not succeed.
+  */
+  bool rewind(void) {
+    frame = 0;
+    pos = sizeof header;
+    haveKey = false;
+    lastFrameTime = micros();
+    return ready;
+  }
+
+  /*!
+    @brief  Read the next frame, wait out the frame's display interval and
+            show() it.
+    @return true on success, false at end of file or on a read or format
+            error.
+  */
+  bool play(void) {
+    neopxl8_video_frame_t rec;
+    if (!ready || (frame >= header.frameCount))
+      return false;
+    pos = neopxl8_video_record_pos(pos, header.align);
+    if (!read(pos, &rec, sizeof rec))
+      return false;
+    pos += sizeof rec;
+    if (map && ((pos > mapSize) || (rec.size > mapSize - pos)))
+      return false;
+
+    bool ok;
+    if (rgb) {
+      switch (rec.type) {
+      case NEOPXL8_FRAME_RAW:
+        if ((ok = (rec.size == header.frameBytes))) {
+          if (map) {
+            show(&map[pos]); // Stage straight from memory
+          } else if ((ok = read(pos, frameBuf, rec.size))) {
+            show(frameBuf);
+          }
+        }
+        break;
+      case NEOPXL8_FRAME_KEY:
+        memset(frameBuf, 0, header.frameBytes);
+        ok = decode(rec.size);
+        break;
+      case NEOPXL8_FRAME_DELTA:
+        if ((ok = haveKey)) {
+          // Prior frame may have been shown from memory, deltas apply to it
+          if (shown != frameBuf)
+            memcpy(frameBuf, shown, header.frameBytes);
+          ok = decode(rec.size);
+        }
+        break;
+      default:
+        ok = false;
+        break;
+      }
+      // A failed frame leaves the framebuffer in an unknown state, so
+      // deltas can't be applied until the next raw or keyframe.
+      haveKey = ok;
+    } else {
+      ok = (rec.type == NEOPXL8_FRAME_RAW) && (rec.size == header.frameBytes) &&
+           readPlanes(rec.size);
+    }
+    if (!ok)
+      return false;
+    pos += rec.size;
+    frame++;
+
+    uint32_t now;
+    while (((now = micros()) - lastFrameTime) < rec.usec)
+      ;
+    lastFrameTime = now;
+    leds.show();
+    return true;
+  }
+
+  /*!
+    @brief  Get the header of the file passed to begin().
+    @return Reference to header (contents undefined if begin() failed).
+  */
+  const neopxl8_video_header_t &getHeader(void) const { return header; }
+
+  /*!
+    @brief  Get the index of the next frame to be played.
+    @return Frame index, 0 to header frameCount.
+  */
+  uint32_t getFrame(void) const { return frame; }
+
+private:
+  // Read n bytes at position p of file or memory image
+  bool read(uint32_t p, void *dst, uint32_t n) {
+    if (map) {
+      if ((p > mapSize) || (n > mapSize - p))
+        return false;
+      memcpy(dst, &map[p], n);
+      return true;
+    }
+    return file->seekSet(p) && (file->read(dst, n) == (int)n);
+  }
+
+  // Check for compressed frames in memory image. If there are none, the
+  // framebuffer isn't needed.
+  bool compressed(void) {
+    neopxl8_video_frame_t rec;
+    uint32_t p = sizeof header;
+    for (uint32_t i = 0; i < header.frameCount; i++) {
+      p = neopxl8_video_record_pos(p, header.align);
+      if (!read(p, &rec, sizeof rec) || (rec.type != NEOPXL8_FRAME_RAW))
+        return true; // Truncated file fails later, in play()
+      p += sizeof rec + rec.size;
+    }
+    return false;
+  }
+
+  // Validate header and set up for file or memory image given to begin()
+  bool init(uint8_t *buf) {
+    if (!read(0, &header, sizeof header) ||
+        memcmp(header.magic, NEOPXL8_VIDEO_MAGIC, 4) ||
+        (header.version != NEOPXL8_VIDEO_VERSION) || (header.lanes != 8) ||
+        (leds.getLanes() != 8) || // 16-lane output not supported
+        (header.strandLength * 8 != leds.numPixels()))
+      return false;
+
+    if (header.layout == NEOPXL8_VIDEO_RGB) {
+      if ((header.bytesPerPixel != 3) ||
+          (header.frameBytes != leds.numPixels() * 3) ||
+          !leds.setLayout(header.width, header.height, header.matrixLayout,
+                          header.rotation,
+                          header.tilesAcross ? header.tilesAcross : 1,
+                          header.tilesDown ? header.tilesDown : 1))
+        return false;
+      rgb = true; // end() reverts layout from here on
+      if (!buf && (!map || compressed())) {
+        if (!(buf = (uint8_t *)malloc(header.frameBytes)))
+          return false;
+        ownBuf = true;
+      }
+      frameBuf = buf;
+      if (buf) {
+        memset(buf, 0, header.frameBytes);
+        show(buf);
+      }
+    } else if (header.layout == NEOPXL8_VIDEO_PLANES) {
+      // Stage buffer size implies bytes per pixel; frame must fill it
+      uint32_t bytes = leds.getStageBufferSize() / NEOPXL8_DMA_BIT_STRIDE;
+      if (!bytes || (header.frameBytes != bytes) ||
+          (header.bytesPerPixel * leds.numPixels() != bytes))
+        return false;
+
+      // File data uses bit N for strand N. If the NeoPXL8 pin assignment
+      // differs (or some strands are disabled), a lookup table remaps bits.
+      remap = false;
+      for (uint8_t b = 0; b < 8; b++) {
+        if (leds.getBitmask(b) != (1 << b))
+          remap = true;
+      }
+      if (remap) {
+        for (uint16_t i = 0; i < 256; i++) {
+          uint8_t m = 0;
+          for (uint8_t b = 0; b < 8; b++) {
+            if (i & (1 << b))
+              m |= leds.getBitmask(b);
+          }
+          lut[i] = m;
+        }
+      }
+    } else {
+      return false;
+    }
+
+    ready = true;
+    return rewind();
+  }
+
+  // Point NeoPXL8 object at RGB frame to stage, if not already there
+  void show(const uint8_t *buf) {
+    if (buf != shown) {
+      leds.setFrameBuffer(buf, NEO_RGB);
+      shown = buf;
+    }
+  }
+
+  // Decode compressed RGB frame payload (at pos) into framebuffer
+  bool decode(uint32_t size) {
+    bool ok;
+    if (map) {
+      neopxl8_mem_source src = {&map[pos], &map[pos + size]};
+      ok = neopxl8_decode(src, frameBuf, header.frameBytes);
+    } else {
+      ok = file->seekSet(pos);
+      in.begin(file, size);
+      ok = ok && neopxl8_decode(in, frameBuf, header.frameBytes);
+    }
+    show(frameBuf);
+    return ok;
+  }
+
+  // Read a NEOPXL8_VIDEO_PLANES frame directly into the DMA buffer
+  bool readPlanes(uint32_t n) {
+    while (!leds.canStage())
+      yield();
+
+    uint8_t *buf = leds.getStageBuffer();
+#if NEOPXL8_DMA_BIT_STRIDE == 1
+    if (!read(pos, buf, n))
+      return false;
+    if (remap) {
+      for (uint32_t i = 0; i < n; i++)
+        buf[i] = lut[buf[i]];
+    }
+#else
+    // Read into last third of DMA buffer, then expand each byte to a
+    // high/data/low triplet, working forward. Output never overtakes the
+    // input not yet read, so this is safe in place.
+    uint8_t *src = &buf[n * 2];
+    if (!read(pos, src, n))
+      return false;
+    if (remap) {
+      for (uint32_t i = 0; i < n; i++) {
+        uint8_t d = lut[*src++];
+        *buf++ = 0xFF;
+        *buf++ = d;
+        *buf++ = 0x00;
+      }
+    } else {
+      for (uint32_t i = 0; i < n; i++) {
+        uint8_t d = *src++;
+        *buf++ = 0xFF;
+        *buf++ = d;
+        *buf++ = 0x00;
+      }
+    }
+#endif
+    leds.setStaged();
+    return true;
+  }
+
+  Adafruit_NeoPXL8 &leds;         ///< NeoPXL8 object being fed
+  File_t *file = NULL;            ///< Video file, if playing from file
+  const uint8_t *map = NULL;      ///< Video data, if playing from memory
+  uint32_t mapSize = 0;           ///< Size of video data in memory
+  neopxl8_video_header_t header;  ///< Copy of file header
+  uint32_t frame = 0;             ///< Index of next frame to play
+  uint32_t pos = 0;               ///< File position following last read
+  uint32_t lastFrameTime = 0;     ///< micros() when last frame was shown
+  uint8_t *frameBuf = NULL;       ///< VIDEO_RGB framebuffer, if needed
+  const uint8_t *shown = NULL;    ///< VIDEO_RGB frame being staged
+  bool ready = false;             ///< If set, begin() succeeded
+  bool rgb = false;               ///< If set, file is NEOPXL8_VIDEO_RGB
+  bool ownBuf = false;            ///< If set, frameBuf was malloc()'d here
+  bool haveKey = false;           ///< If set, shown is a valid frame
+  bool remap = false;             ///< If set, file bits are remapped by lut
+  uint8_t lut[256];               ///< File-to-DMA bitmask lookup table
+  neopxl8_file_source<File_t> in; ///< Compressed payload reader
+};
+
+#endif // ARDUINO
+
+#endif // _ADAFRUIT_NEOPXL8VIDEO_H_
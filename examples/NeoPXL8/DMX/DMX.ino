@@ -0,0 +1,77 @@
+// FIRST TIME HERE? START WITH THE NEOPXL8 strandtest EXAMPLE INSTEAD!
+// That code explains and helps troubshoot wiring and NeoPixel color format.
+
+// Receives E1.31 (sACN) or Art-Net lighting data over WiFi (ESP32-S3) and
+// displays it on NeoPXL8 strands. Each strand gets its own block of DMX
+// universes, starting from channel 1 of each: with 170 RGB pixels per
+// strand, that's one universe per strand. The lighting console or software
+// should patch pixels as RGB; NeoPXL8 converts to the strands' own color
+// order as it stages each frame. Adafruit_NeoPXL8DMX itself doesn't depend
+// on WiFi; packets from Ethernet or any other source can be passed to
+// parse() the same way.
+
+#include <Adafruit_NeoPXL8.h>
+#include <Adafruit_NeoPXL8DMX.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#define WIFI_SSID     "your-ssid"
+#define WIFI_PASSWORD "your-password"
+
+#define NUM_LEDS       170                 // NeoPixels PER STRAND
+#define COLOR_ORDER    NEO_GRB             // NeoPixel color format
+#define PORT           NEOPXL8_E131_PORT   // Or NEOPXL8_ARTNET_PORT
+#define FIRST_UNIVERSE 1                   // Art-Net universes start at 0
+
+// Unicast only: set the console to send to this board's IP address, which
+// is printed at startup.
+
+int8_t pins[8] = NEOPXL8_DEFAULT_PINS; // CHANGE to match strandtest
+Adafruit_NeoPXL8 leds(NUM_LEDS, pins, COLOR_ORDER);
+uint8_t frame[NUM_LEDS * 8 * 3]; // RGB data from DMX, 8 strands
+Adafruit_NeoPXL8DMX dmx(frame, NUM_LEDS * 8);
+WiFiUDP udp;
+uint8_t packet[640]; // Largest E1.31 packet is 638 bytes
+
+void setup() {
+  Serial.begin(115200);
+
+  if (!leds.begin()) {
+    pinMode(LED_BUILTIN, OUTPUT);
+    for (;;) digitalWrite(LED_BUILTIN, (millis() / 500) & 1);
+  }
+  leds.setFrameBuffer(frame, NEO_RGB);
+  leds.show(); // LEDs off ASAP
+
+  // Map each strand to its own universes
+  uint16_t universesPerStrand = (NUM_LEDS + 169) / 170;
+  for (uint8_t s = 0; s < 8; s++) {
+    dmx.mapUniverses(FIRST_UNIVERSE + s * universesPerStrand, s * NUM_LEDS,
+                     NUM_LEDS);
+  }
+
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  while (WiFi.status() != WL_CONNECTED) delay(100);
+  WiFi.setSleep(false); // Lower, steadier latency
+  Serial.print("IP address: ");
+  Serial.println(WiFi.localIP());
+  udp.begin(PORT);
+}
+
+void loop() {
+  int len;
+  while ((len = udp.parsePacket()) > 0) {
+    len = udp.read(packet, sizeof packet);
+    if (dmx.parse(packet, len) == NEOPXL8_DMX_SHOW) leds.show();
+  }
+
+  // Every few seconds, report packet loss for the first universe
+  static uint32_t lastReport = 0;
+  if ((millis() - lastReport) >= 5000) {
+    lastReport = millis();
+    Serial.printf("Universe %d: %u packets, %u lost%s\n", FIRST_UNIVERSE,
+                  (unsigned)dmx.getPackets(FIRST_UNIVERSE),
+                  (unsigned)dmx.getLost(FIRST_UNIVERSE),
+                  dmx.isSynced() ? " (synced)" : "");
+  }
+}
@@ -99,6 +99,12 @@ https://github.com/PaulStoffregen/OctoWS2811/tree/master/extras
     than width/height, as not all projects are using a grid. Be warned that
     JSON is highly picky and even a single missing or excess comma will stop
     everything, so read through it very carefully if encountering an error.
+
+    Playback uses Adafruit_NeoPXL8Pipeline, so reading the next frame from
+    the filesystem overlaps with converting and transmitting the current
+    one. On RP2040 and ESP32-S3, file reads happen in loop() while output
+    runs on the other core. On SAMD, output and reads alternate in loop(),
+    the next frame being read while the LEDs update via DMA.
 */
 
 #define FILENAME "mymovie.bin"
@@ -111,13 +117,16 @@ uint16_t led_width  = 30; // Number of LEDs horizontally
 uint16_t led_height = 16; // Number of LEDs vertically
 uint8_t  led_layout = 0;  // 0 = even rows left->right, 1 = right->left
 
+#if defined(ARDUINO_ARCH_RP2040) || defined(CONFIG_IDF_TARGET_ESP32S3)
+#define THREADED true // Reader and output run concurrently on 2 cores
+#else
+#define THREADED false // Output stage calls reader itself
+#endif
+
 FatFile file;
-bool playing = false;
-uint32_t timeOfLastFrame = 0;
-uint8_t *imageBuffer;     // LED data from filesystem is staged here
-uint32_t imageBufferSize; // Size (in bytes) of imageBuffer
 
 Adafruit_NeoPXL8 *leds; // NeoPXL8 object is allocated after reading config
+Adafruit_NeoPXL8Pipeline *pipeline = NULL; // Likewise, playback pipeline
 
 void error_handler(const char *message, uint16_t speed) {
   Serial.print("Error: ");
@@ -192,24 +201,37 @@ void setup() {
   leds = new Adafruit_NeoPXL8(led_width * led_height / 8, pins, order);
   if (leds == NULL) error_handler("NeoPXL8 allocation", 100);
 
-  // Allocate imageBuffer
-  imageBufferSize = led_width * led_height * 3;
-  imageBuffer = (uint8_t *)malloc(imageBufferSize);
-  if (imageBuffer == NULL) error_handler("Image buffer allocation", 200);
-
   if (!leds->begin()) error_handler("NeoPXL8 begin() failed", 500);
 
-  // At this point, everything but input file is ready to go!
+  // Rather than setPixelColor() for every pixel of every frame, NeoPXL8
+  // is told how the LED matrix is arranged, and the pipeline passes each
+  // video frame to NeoPXL8 to stage directly from the file data.
+  if (!leds->setLayout(led_width, led_height, led_layout))
+    error_handler("Invalid LED layout", 300);
 
   leds->show(); // LEDs off ASAP
 
   bool status = file.open(FILENAME, O_RDONLY);
   if (!status) error_handler("Can't open movie .bin file", 1000);
   Serial.println("File opened");
-  playing = true;
-  timeOfLastFrame = 0;
+
+  // Allocate and start pipeline (this allocates the frame buffers)
+  pipeline = new Adafruit_NeoPXL8Pipeline(*leds);
+  if ((pipeline == NULL) ||
+      !pipeline->begin(led_width * led_height * 3, read_frame, NULL, NEO_RGB,
+                       THREADED))
+    error_handler("Pipeline allocation", 200);
+  pipeline->setConverter(convert);
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+  // Run loop0() on core 0 (Arduino uses core 1) w/16K stack
+  (void)xTaskCreatePinnedToCore(loop0, "NeoPXL8Pipe", 16384, NULL, 0, NULL, 0);
+#endif
 }
 
+static unsigned int bufpos = 0; // sd_card_read() buffer state, reset
+static unsigned int buflen = 0; // when rewinding file
+
 // read from the SD card, true=ok, false=unable to read
 // the SD library is much faster if all reads are 512 bytes
 // this function lets us easily read any size, but always
@@ -218,8 +240,6 @@ void setup() {
 bool sd_card_read(void *ptr, unsigned int len)
 {
   static unsigned char buffer[512];
-  static unsigned int bufpos = 0;
-  static unsigned int buflen = 0;
   unsigned char *dest = (unsigned char *)ptr;
   unsigned int n;
 
@@ -255,113 +275,113 @@ void sd_card_skip(unsigned int len)
 }
 
 
-void loop()
+// Pipeline reader stage: read the next video frame into buf. Audio chunks
+// are skipped. At end of file (or on error), playback restarts from the
+// beginning.
+bool read_frame(uint8_t *buf, uint32_t len, uint32_t *usec, void *arg)
 {
   unsigned char header[5];
+  bool rewound = false;
 
-  if (playing) {
+  for (;;) {
     if (sd_card_read(header, 5)) {
       if (header[0] == '*') {
         // found an image frame
         unsigned int size = (header[1] | (header[2] << 8)) * 3;
-        unsigned int usec = header[3] | (header[4] << 8);
         unsigned int readsize = size;
-	      //Serial.printf("v: %u %u\n", size, usec);
-        if (readsize > imageBufferSize) {
-          readsize = imageBufferSize;
+        *usec = header[3] | (header[4] << 8);
+        if (readsize > len) {
+          readsize = len;
+        } else if (readsize < len) {
+          memset(&buf[readsize], 0, len - readsize);
         }
-        if (sd_card_read(imageBuffer, readsize)) {
-          uint32_t now;
-          // Serial.printf(", us = %u", (unsigned int)(micros() - timeOfLastFrame));
-          // Serial.println();
-          do {
-            now = micros();
-          } while ((now - timeOfLastFrame) < usec) ; // wait
-          timeOfLastFrame = now;
-          convert_and_show();
-        } else {
+        if (!sd_card_read(buf, readsize)) {
           error("unable to read video frame data");
-          return;
-        }
-        if (readsize < size) {
-          sd_card_skip(size - readsize);
+        } else {
+          if (readsize < size) {
+            sd_card_skip(size - readsize);
+          }
+          return true;
         }
       } else if (header[0] == '%') {
-        // found a chunk of audio data
+        // found a chunk of audio data, skip it
         unsigned int size = (header[1] | (header[2] << 8)) * 2;
-#if 0
-        // Serial.printf("a: %u", size);
-      	// Serial.println();
-      	while (size > 0) {
-      	  unsigned int len = size;
-      	  if (len > 256) len = 256;
-      	  int16_t *p = audio.getBuffer();
-      	  if (!sd_card_read(p, len)) {
-      	    error("unable to read audio frame data");
-                  return;
-      	  }
-      	  if (len < 256) {
-                  for (int i=len; i < 256; i++) {
-                    *((char *)p + i) = 0;  // fill rest of buffer with zero
-                  }
-      	  }
-                audio.playBuffer();
-      	  size -= len;
-      	}
-#else
-        file.seekCur(size);
-#endif
+        sd_card_skip(size);
+        continue;
       } else {
         error("unknown header");
-        return;
       }
-    } else {
-      error("unable to read 5-byte header");
-      return;
-    }
-  } else {
-    delay(2000);
-    bool status = file.open(FILENAME, FILE_READ);
-    if (status) {
-      Serial.println("File opened");
-      playing = true;
-      timeOfLastFrame = micros();
     }
+    // End of file or error, start over (but not endlessly if no frames)
+    if (rewound) return false;
+    file.seekSet(0);
+    bufpos = buflen = 0;
+    rewound = true;
   }
 }
 
-// when any error happens during playback, close the file and restart
+// when any error happens during playback, report it, reader restarts file
 void error(const char *str)
 {
   Serial.print("error: ");
   Serial.println(str);
-  file.close();
-  playing = false;
 }
 
-void convert_and_show() {
-  uint8_t *ptr = imageBuffer;
-  if (led_layout == 0) {
-    for (int y=0; y<led_height; y++) {
-      for (int x=0; x<led_width; x++) {
-        int pixelIndex = y * led_width + x; // Always left-to-right
-        uint8_t r = leds->gamma8(*ptr++);
-        uint8_t g = leds->gamma8(*ptr++);
-        uint8_t b = leds->gamma8(*ptr++);
-        leds->setPixelColor(pixelIndex, r, g, b);
-      }
-    }
-  } else {
-    for (int y=0; y<led_height; y++) {
-      for (int x=0; x<led_width; x++) {
-        // Even rows are left-to-right, odd are right-to-left
-        int pixelIndex = (y & 1) ? (y + 1) * led_width - 1 - x : y * led_width + x;
-        uint8_t r = leds->gamma8(*ptr++);
-        uint8_t g = leds->gamma8(*ptr++);
-        uint8_t b = leds->gamma8(*ptr++);
-        leds->setPixelColor(pixelIndex, r, g, b);
-      }
-    }
+// Pipeline converter stage: pixel order and color order are handled by
+// NeoPXL8 (see setup()), only gamma correction is applied here.
+void convert(uint8_t *buf, uint32_t len, void *arg) {
+  for (uint32_t i=0; i<len; i++) {
+    buf[i] = leds->gamma8(buf[i]);
+  }
+}
+
+void loop()
+{
+#if THREADED
+  pipeline->read(); // Output runs on the other core
+#else
+  pipeline->show(); // Reads next frame itself while LEDs update
+#endif
+
+  // Print pipeline statistics every few seconds
+  static uint32_t lastStats = 0;
+  if ((millis() - lastStats) >= 5000) {
+    const neopxl8_pipeline_stats_t &stats = pipeline->getStats();
+    Serial.print("Frames: ");
+    Serial.print(stats.frames);
+    Serial.print(" stalls: ");
+    Serial.print(stats.stalls);
+    Serial.print(" read/convert/output/idle uS: ");
+    Serial.print(stats.read);
+    Serial.print('/');
+    Serial.print(stats.convert);
+    Serial.print('/');
+    Serial.print(stats.output);
+    Serial.print('/');
+    Serial.println(stats.idle);
+    lastStats = millis();
   }
-  leds->show();
 }
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+// On RP2040, the pipeline output stage (gamma, staging, show()) runs on the
+// second core via loop1(), while loop() on the first core reads the file
+// (keeping filesystem access on the same core as USB mass storage).
+
+void loop1() {
+  if (pipeline) pipeline->show();
+}
+
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+
+// On ESP32S3, the output stage runs in a tight loop on core 0, while the
+// Arduino loop() on core 1 reads the file.
+
+void loop0(void *param) {
+  for (;;) {
+    pipeline->show();
+  }
+}
+
+#endif // end ESP32S3
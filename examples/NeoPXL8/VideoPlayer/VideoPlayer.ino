@@ -0,0 +1,137 @@
+// FIRST TIME HERE? START WITH THE NEOPXL8 strandtest EXAMPLE INSTEAD!
+// That code explains and helps troubshoot wiring and NeoPixel color format.
+
+// Plays .npx video from the on-board flash filesystem. This is like the
+// VideoMSC example, but frames are converted ahead of time on a computer,
+// using extras/neopxl8video, in one of two formats:
+// - "planes" frames are already in NeoPXL8's DMA format. Each frame is read
+//   from the file straight into the DMA buffer, with no per-pixel work on
+//   the microcontroller, so much larger LED matrices can run at full frame
+//   rate.
+// - "rgb" frames are compressed, so files are much smaller and less data
+//   is read from flash per frame. Only changed pixels are decoded, and
+//   NeoPXL8 handles layout and color order as it stages each frame.
+
+// Create the .npx file with movie2msc (extras/Processing) and then e.g.:
+//   neopxl8video -w 30 -h 16 -l 0 -o GRB mymovie.bin mymovie.npx
+// or
+//   neopxl8video -w 30 -h 16 -l 0 -f rgb mymovie.bin mymovie.npx
+// Width, height and layout (plus color order for planes) are baked into
+// the .npx file, so they must match the LEDs; see neopxl8video usage for
+// other settings. Copy mymovie.npx to CIRCUITPY. Pins (and color order for
+// rgb) are read from CIRCUITPY/neopxl8.cfg as in VideoMSC (other settings
+// there are ignored by this sketch):
+//
+//   {
+//     "pins" : [ 16, 17, 18, 19, 20, 21, 22, 23 ],
+//     "order" : "GRB"
+//   }
+
+// On RP2040 and RP2350, flash is mapped into the address space, and video
+// is played straight from there (no filesystem reads, and no RAM needed
+// for uncompressed rgb frames) if the file is stored contiguously. That's
+// normally the case for files copied to CIRCUITPY, unless the drive has
+// become fragmented; the sketch falls back on normal file reads if not.
+
+#include "SdFat_Adafruit_Fork.h"
+#include <Adafruit_NeoPXL8.h>
+#include <Adafruit_NeoPXL8Video.h>
+#include <Adafruit_CPFS.h> // For accessing CIRCUITPY drive
+#define ARDUINOJSON_ENABLE_COMMENTS 1
+#include <ArduinoJson.h>
+
+#define FILENAME "mymovie.npx"
+
+#if defined(ARDUINO_ARCH_RP2040)
+// Adafruit_CPFS places CIRCUITPY 1 MB into flash, as CircuitPython does
+#define FS_BASE ((const uint8_t *)XIP_BASE + 1024 * 1024)
+#endif
+
+FatFile file;
+Adafruit_NeoPXL8 *leds;                  // Allocated after reading header
+Adafruit_NeoPXL8Player<FatFile> *player; // Likewise
+
+void error_handler(const char *message, uint16_t speed) {
+  Serial.print("Error: ");
+  Serial.println(message);
+  if (speed) { // Fatal error, blink LED
+    pinMode(LED_BUILTIN, OUTPUT);
+    for (;;) {
+      digitalWrite(LED_BUILTIN, (millis() / speed) & 1);
+      yield(); // Keep filesystem accessible for editing
+    }
+  } else { // Not fatal, just show message
+    Serial.println("Continuing with defaults");
+  }
+}
+
+void setup() {
+  // CHANGE these to match your strandtest findings (or use .cfg file):
+  int8_t pins[8] = NEOPXL8_DEFAULT_PINS;
+  uint16_t order = NEO_GRB;
+
+  // Start the CIRCUITPY flash filesystem first. Very important!
+  FatVolume *fs = Adafruit_CPFS::begin();
+
+  // Start Serial AFTER FFS begin, else CIRCUITPY won't show on computer.
+  Serial.begin(115200);
+  //while(!Serial);
+  delay(1000);
+  Serial.println("VideoPlayer");
+
+  if (fs == NULL) error_handler("Can't access CIRCUITPY drive", 1000);
+
+  StaticJsonDocument<1024> doc;
+  if ((file = fs->open("neopxl8.cfg", FILE_READ))) {
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+      error_handler("neopxl8.cfg syntax error", 0);
+    } else {
+      JsonVariant v = doc["pins"];
+      if (v.is<JsonArray>()) {
+        uint8_t n = v.size() < 8 ? v.size() : 8;
+        for (uint8_t i = 0; i < n; i++)
+          pins[i] = v[i].as<int>();
+      }
+
+      v = doc["order"];
+      if (v.is<const char *>()) order = Adafruit_NeoPixel::str2order(v);
+    }
+  } else {
+    error_handler("neopxl8.cfg not found", 0);
+  }
+
+  // LED count comes from the video file header. For planes format, color
+  // order is already baked into the file, so only RGB vs RGBW matters.
+  if (!file.open(FILENAME, O_RDONLY))
+    error_handler("Can't open " FILENAME, 500);
+  neopxl8_video_header_t header;
+  if (file.read(&header, sizeof header) != (int)sizeof header)
+    error_handler("Can't read header", 500);
+  if (header.layout == NEOPXL8_VIDEO_PLANES)
+    order = (header.bytesPerPixel == 4) ? NEO_RGBW : NEO_RGB;
+  leds = new Adafruit_NeoPXL8(header.strandLength, pins, order);
+  if (leds == NULL) error_handler("NeoPXL8 allocation", 100);
+  if (!leds->begin()) error_handler("NeoPXL8 begin() failed", 200);
+  leds->show(); // LEDs off ASAP
+
+  player = new Adafruit_NeoPXL8Player<FatFile>(*leds);
+  bool ok = false;
+#if defined(FS_BASE)
+  const uint8_t *data = neopxl8_xip_map(&file, FS_BASE);
+  if (data) {
+    Serial.println("Playing from memory-mapped flash");
+    ok = player->begin(data, file.fileSize());
+  }
+#endif
+  if (!ok && !player->begin(&file)) error_handler("Invalid .npx file", 300);
+  Serial.print(header.frameCount);
+  Serial.println(" frames");
+}
+
+void loop() {
+  if (!player->play()) { // End of file (or error), restart
+    player->rewind();
+  }
+}
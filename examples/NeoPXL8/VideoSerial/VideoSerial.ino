@@ -5,9 +5,23 @@
 // That code explains and helps troubshoot wiring and NeoPixel color format.
 
 // This is a companion to "move2serial" in the extras/Processing folder.
+// It also accepts the NeoPXL8 binary stream protocol, sent by the faster
+// (compressed frames) and more robust (CRC-checked) "neopxl8send" program
+// in the extras/neopxl8send folder.
 
 #include "SdFat_Adafruit_Fork.h"
 #include <Adafruit_NeoPXL8.h>
+#include <Adafruit_NeoPXL8Video.h>
+
+// With the Adafruit TinyUSB stack, binary stream data is received in the
+// TinyUSB CDC callback straight into one of two packet buffers, so the
+// next frame arrives while the current one is shown. On RP2040 this
+// callback runs from an interrupt. ESP32's own USB core claims the same
+// callback, so there the stream is read in loop() instead.
+#if defined(USE_TINYUSB) && !defined(ARDUINO_ARCH_ESP32)
+#define USB_CALLBACK
+#include <Adafruit_TinyUSB.h>
+#endif
 #include <Adafruit_CPFS.h> // For accessing CIRCUITPY drive
 #define ARDUINOJSON_ENABLE_COMMENTS 1
 #include <ArduinoJson.h>
@@ -137,8 +151,11 @@ uint8_t *imageBuffer;     // Serial LED data is received here
 uint32_t imageBufferSize; // Size (in bytes) of imageBuffer
 int8_t   sync_pin = -1;   // If multiple boards, wire pins together
 uint32_t lastFrameSyncTime = 0;
+uint8_t *packetBuffer;    // Binary stream packets are received here (x2)
+volatile bool legacy = false; // If set, OctoWS2811 message being read
 
 Adafruit_NeoPXL8 *leds; // NeoPXL8 object is allocated after reading config
+Adafruit_NeoPXL8Receiver *rx; // Binary stream decoder, writes imageBuffer
 
 void error_handler(const char *message, uint16_t speed) {
   Serial.print("Error: ");
@@ -221,9 +238,26 @@ void setup() {
   imageBufferSize = led_width * led_height * 3;
   imageBuffer = (uint8_t *)malloc(imageBufferSize);
   if (imageBuffer == NULL) error_handler("Image buffer allocation", 200);
+  memset(imageBuffer, 0, imageBufferSize); // Start with LEDs off
+
+  // Binary stream packets are decoded into imageBuffer. Two packet
+  // buffers let one be received while the other is decoded.
+  packetBuffer = (uint8_t *)malloc(imageBufferSize * 2);
+  if (packetBuffer == NULL) error_handler("Packet buffer allocation", 200);
+  rx = new Adafruit_NeoPXL8Receiver(imageBuffer, imageBufferSize,
+                                    packetBuffer, imageBufferSize,
+                                    packetBuffer + imageBufferSize);
+  if (rx == NULL) error_handler("Receiver allocation", 200);
 
   if (!leds->begin()) error_handler("NeoPXL8 begin() failed", 500);
 
+  // Rather than setPixelColor() for every pixel of every frame, NeoPXL8
+  // is told how the LED matrix is arranged and pointed at imageBuffer.
+  // Each show() then stages video frames directly from imageBuffer.
+  if (!leds->setLayout(led_width, led_height, led_layout))
+    error_handler("Invalid LED layout", 300);
+  leds->setFrameBuffer(imageBuffer, NEO_RGB);
+
   // At this point, everything is fully configured, allocated and started!
 
   leds->show(); // LEDs off ASAP
@@ -232,6 +266,21 @@ void setup() {
 }
 
 void loop() {
+  // Binary stream packets start with a non-ASCII byte. Once one begins,
+  // all data goes to the receiver until the packet ends.
+  legacy = false;
+#if defined(USB_CALLBACK)
+  pump(); // In case callback stopped with both packet buffers full
+  show_stream();
+  if (!rx->idle() || (Serial.peek() == NEOPXL8_STREAM_SYNC0)) return;
+#else
+  if (!rx->idle() || (Serial.peek() == NEOPXL8_STREAM_SYNC0)) {
+    receive_stream();
+    return;
+  }
+#endif
+  legacy = true; // Keep callback out of OctoWS2811 message data
+
 //
 // wait for a Start-Of-Message character:
 //
@@ -274,8 +323,7 @@ void loop() {
     unsigned int usecUntilFrameSync = 0;
     int count = Serial.readBytes((char *)&usecUntilFrameSync, 2);
     if (count != 2) return;
-    count = Serial.readBytes((char *)imageBuffer, imageBufferSize);
-    if (count == imageBufferSize) {
+    if (read_image()) {
       unsigned int endAt = micros();
       unsigned int usToWaitBeforeSyncOutput = 100;
       if (endAt - startAt < usecUntilFrameSync) {
@@ -296,8 +344,7 @@ void loop() {
     unsigned int usecUntilFrameSync = 0;
     int count = Serial.readBytes((char *)&usecUntilFrameSync, 2);
     if (count != 2) return;
-    count = Serial.readBytes((char *)imageBuffer, imageBufferSize);
-    if (count == imageBufferSize) {
+    if (read_image()) {
       digitalWrite(sync_pin, HIGH);
       pinMode(sync_pin, OUTPUT);
       uint32_t now, elapsed;
@@ -317,8 +364,7 @@ void loop() {
     unsigned int unusedField = 0;
     int count = Serial.readBytes((char *)&unusedField, 2);
     if (count != 2) return;
-    count = Serial.readBytes((char *)imageBuffer, imageBufferSize);
-    if (count == imageBufferSize) {
+    if (read_image()) {
       uint32_t startTime = millis();
       while (digitalRead(sync_pin) != HIGH && (millis() - startTime) < 30) ; // wait for sync high
       while (digitalRead(sync_pin) != LOW && (millis() - startTime) < 30) ;  // wait for sync high->low
@@ -364,29 +410,96 @@ void loop() {
   }
 }
 
+// Read a legacy-protocol frame into imageBuffer. The binary stream's
+// deltas no longer apply as soon as this starts writing there, even if
+// the frame then times out partway or misses its sync, so the receiver
+// is reset first (it waits for the next keyframe).
+bool read_image() {
+  rx->reset();
+  return Serial.readBytes((char *)imageBuffer, imageBufferSize) ==
+         imageBufferSize;
+}
+
 void convert_and_show() {
-  uint8_t *ptr = imageBuffer;
-  if (led_layout == 0) {
-    for (int y=0; y<led_height; y++) {
-      for (int x=0; x<led_width; x++) {
-        int pixelIndex = y * led_width + x; // Always left-to-right
-        uint8_t r = leds->gamma8(*ptr++);
-        uint8_t g = leds->gamma8(*ptr++);
-        uint8_t b = leds->gamma8(*ptr++);
-        leds->setPixelColor(pixelIndex, r, g, b);
-      }
-    }
-  } else {
-    for (int y=0; y<led_height; y++) {
-      for (int x=0; x<led_width; x++) {
-        // Even rows are left-to-right, odd are right-to-left
-        int pixelIndex = (y & 1) ? (y + 1) * led_width - 1 - x : y * led_width + x;
-        uint8_t r = leds->gamma8(*ptr++);
-        uint8_t g = leds->gamma8(*ptr++);
-        uint8_t b = leds->gamma8(*ptr++);
-        leds->setPixelColor(pixelIndex, r, g, b);
-      }
-    }
+  // Pixel order and color order are handled by NeoPXL8 (see setup()),
+  // only gamma correction is applied here.
+  for (uint32_t i=0; i<imageBufferSize; i++) {
+    imageBuffer[i] = leds->gamma8(imageBuffer[i]);
   }
   leds->show();
 }
+
+// Show frame decoded from the binary stream, if any. Delta frames only
+// change pixels that differ from the prior frame, so imageBuffer is used
+// as-is; the sender has already applied gamma correction. Each frame is
+// shown 'usec' after the previous one (as with '$' messages), or right
+// away if 0.
+void show_stream() {
+  uint32_t usec;
+  if (rx->available(&usec)) {
+    digitalWrite(sync_pin, HIGH);
+    pinMode(sync_pin, OUTPUT);
+    uint32_t now, elapsed;
+    do {
+      now = micros();
+      elapsed = now - lastFrameSyncTime;
+    } while (elapsed < usec); // wait
+    lastFrameSyncTime = now;
+    digitalWrite(sync_pin, LOW);
+    leds->show();
+  }
+  // Lost or damaged packet, ask sender for a keyframe
+  if (rx->nak()) Serial.write(NEOPXL8_STREAM_NAK);
+}
+
+#if defined(USB_CALLBACK)
+
+volatile bool pumping = false;
+
+// Move waiting USB data to the receiver: header and CRC bytes one at a
+// time, payload directly from the TinyUSB FIFO into a packet buffer.
+// Stops at data that isn't a binary packet (left for loop()) or if both
+// packet buffers are full (data waits in the FIFO, and USB flow control
+// holds off the sender).
+void pump() {
+  if (pumping || legacy) return; // Interrupted loop() mid-pump or message
+  pumping = true;
+  while (tud_cdc_available()) {
+    uint32_t len;
+    uint8_t *dst = rx->getWriteBuffer(&len);
+    if (dst) {
+      rx->written(tud_cdc_read(dst, len));
+    } else {
+      uint8_t b;
+      if (!tud_cdc_peek(&b)) break;
+      if (rx->idle() && (b != NEOPXL8_STREAM_SYNC0)) break;
+      if (!rx->feed(&b, 1)) break;
+      tud_cdc_read_char();
+    }
+  }
+  pumping = false;
+}
+
+// TinyUSB calls this when CDC data arrives
+extern "C" void tud_cdc_rx_cb(uint8_t itf) { pump(); }
+
+#else
+
+// Pass waiting serial data to the binary stream receiver, showing each
+// frame as it's decoded.
+void receive_stream() {
+  uint8_t buf[256];
+  int n = Serial.available();
+  if (n <= 0) return;
+  if (n > (int)sizeof buf) n = sizeof buf;
+  n = Serial.readBytes((char *)buf, n);
+  uint8_t *ptr = buf;
+  while (n > 0) {
+    uint32_t used = rx->feed(ptr, n);
+    ptr += used;
+    n -= used;
+    show_stream();
+  }
+}
+
+#endif // USB_CALLBACK
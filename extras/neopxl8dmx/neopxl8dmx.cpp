@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// neopxl8dmx: exercise Adafruit_NeoPXL8DMX (E1.31 / Art-Net decoder) on a
+// host computer. Can listen for live packets from a lighting console or
+// software, replay packets from a pcap capture file (e.g. saved from
+// Wireshark or tcpdump), or run a self-test over UDP loopback.
+// THIS IS A HOST COMPUTER PROGRAM, NOT ARDUINO CODE. Build with:
+//
+//   g++ -O2 -I../.. -o neopxl8dmx neopxl8dmx.cpp
+//
+// Run without arguments for usage.
+
+#include <Adafruit_NeoPXL8DMX.h>
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] --listen\n"
+          "       %s [options] --pcap file.pcap\n"
+          "       %s --selftest\n"
+          "  -n, --pixels N       Pixel count (default 1360, 8 x 170)\n"
+          "  -u, --universe N     First universe (default 1)\n"
+          "  -c, --channels N     Channels per pixel, 3 or 4 (default 3)\n"
+          "  -l, --listen         Receive E1.31 and Art-Net on UDP\n"
+          "  -p, --pcap FILE      Replay UDP packets from capture file\n"
+          "  -s, --selftest       Loopback test, exits nonzero on failure\n",
+          prog, prog, prog);
+  exit(1);
+}
+
+static void print_stats(const Adafruit_NeoPXL8DMX &dmx, uint16_t first,
+                        uint16_t count, uint32_t shows) {
+  printf("%u frames%s\n", (unsigned)shows, dmx.isSynced() ? " (synced)" : "");
+  for (uint16_t u = first; u < first + count; u++) {
+    printf("  universe %u: %u packets, %u lost\n", u,
+           (unsigned)dmx.getPackets(u), (unsigned)dmx.getLost(u));
+  }
+}
+
+static int udp_socket(uint16_t port) {
+  int s = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_port = htons(port);
+  a.sin_addr.s_addr = htonl(INADDR_ANY);
+  int on = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+  if ((s < 0) || bind(s, (struct sockaddr *)&a, sizeof a)) {
+    perror("socket");
+    exit(1);
+  }
+  return s;
+}
+
+// LISTEN & REPLAY ---------------------------------------------------------
+
+static int listen_udp(Adafruit_NeoPXL8DMX &dmx, uint16_t first,
+                      uint16_t count) {
+  struct pollfd p[2] = {{udp_socket(NEOPXL8_E131_PORT), POLLIN, 0},
+                        {udp_socket(NEOPXL8_ARTNET_PORT), POLLIN, 0}};
+  uint8_t buf[1500];
+  uint32_t shows = 0;
+  time_t last = time(NULL);
+  for (;;) {
+    if (poll(p, 2, 100) > 0) {
+      for (int i = 0; i < 2; i++) {
+        if (p[i].revents & POLLIN) {
+          ssize_t n = recv(p[i].fd, buf, sizeof buf, 0);
+          if ((n > 0) && (dmx.parse(buf, n) == NEOPXL8_DMX_SHOW))
+            shows++;
+        }
+      }
+    }
+    if (time(NULL) != last) {
+      last = time(NULL);
+      print_stats(dmx, first, count, shows);
+    }
+  }
+  return 0;
+}
+
+// Minimal pcap reader: Ethernet (or Linux "cooked") IPv4 UDP packets only
+static int replay_pcap(Adafruit_NeoPXL8DMX &dmx, const char *filename,
+                       uint16_t first, uint16_t count) {
+  FILE *f = fopen(filename, "rb");
+  if (!f) {
+    perror(filename);
+    return 1;
+  }
+  uint32_t hdr[6];
+  if ((fread(hdr, 4, 6, f) != 6) || (hdr[0] != 0xA1B2C3D4)) {
+    fprintf(stderr, "Not a (little-endian, microsecond) pcap file\n");
+    return 1;
+  }
+  uint32_t link = hdr[5], linkLen = (link == 113) ? 16 : 14, shows = 0;
+  uint32_t packets = 0, rec[4];
+  std::vector<uint8_t> buf;
+  while (fread(rec, 4, 4, f) == 4) {
+    buf.resize(rec[2]);
+    if (fread(buf.data(), 1, rec[2], f) != rec[2])
+      break;
+    packets++;
+    if (rec[2] < linkLen + 28)
+      continue;
+    const uint8_t *ip = &buf[linkLen];
+    uint32_t ihl = (ip[0] & 0x0F) * 4;
+    if (((ip[0] >> 4) != 4) || (ip[9] != 17) || (linkLen + ihl + 8 > rec[2]))
+      continue;
+    const uint8_t *udp = &ip[ihl];
+    if (dmx.parse(udp + 8, rec[2] - linkLen - ihl - 8) == NEOPXL8_DMX_SHOW)
+      shows++;
+  }
+  fclose(f);
+  printf("%u packets read\n", (unsigned)packets);
+  print_stats(dmx, first, count, shows);
+  return 0;
+}
+
+// SELF-TEST ---------------------------------------------------------------
+
+// Build an E1.31 data packet for 'count' channels, or sync packet if
+// data is NULL
+static std::vector<uint8_t> e131(uint16_t universe, uint8_t seq,
+                                 uint16_t syncAddr, const uint8_t *data,
+                                 uint16_t count) {
+  std::vector<uint8_t> p(data ? 126 + count : 49);
+  static const char acn[12] = "ASC-E1.17";
+  p[1] = 0x10;
+  memcpy(&p[4], acn, 12);
+  p[21] = data ? 0x04 : 0x08;
+  if (data) {
+    p[43] = 0x02;
+    p[108] = 100; // Priority
+    p[109] = syncAddr >> 8;
+    p[110] = syncAddr;
+    p[111] = seq;
+    p[113] = universe >> 8;
+    p[114] = universe;
+    p[117] = 0x02;
+    p[118] = 0xA1;
+    p[122] = 0x01;
+    p[123] = (count + 1) >> 8;
+    p[124] = count + 1;
+    memcpy(&p[126], data, count);
+  } else {
+    p[43] = 0x01;
+    p[44] = seq;
+    p[45] = syncAddr >> 8;
+    p[46] = syncAddr;
+  }
+  return p;
+}
+
+// Build an ArtDmx packet, or ArtSync if data is NULL
+static std::vector<uint8_t> artnet(uint16_t universe, uint8_t seq,
+                                   const uint8_t *data, uint16_t count) {
+  std::vector<uint8_t> p(data ? 18 + count : 14);
+  memcpy(&p[0], "Art-Net", 8);
+  p[9] = data ? 0x50 : 0x52;
+  p[11] = 14;
+  if (data) {
+    p[12] = seq;
+    p[14] = universe;
+    p[15] = universe >> 8;
+    p[16] = count >> 8;
+    p[17] = count;
+    memcpy(&p[18], data, count);
+  }
+  return p;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+  if (!ok)
+    failures++;
+}
+
+// Send packet over loopback and parse what arrives
+static neopxl8_dmx_result_t loop_packet(int tx, int rx,
+                                        const struct sockaddr_in &to,
+                                        Adafruit_NeoPXL8DMX &dmx,
+                                        const std::vector<uint8_t> &p) {
+  uint8_t buf[1500];
+  sendto(tx, p.data(), p.size(), 0, (const struct sockaddr *)&to, sizeof to);
+  ssize_t n = recv(rx, buf, sizeof buf, 0);
+  return (n > 0) ? dmx.parse(buf, n) : NEOPXL8_DMX_NONE;
+}
+
+static int selftest(void) {
+  int rx = udp_socket(0), tx = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in to;
+  socklen_t len = sizeof to;
+  getsockname(rx, (struct sockaddr *)&to, &len);
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  // E1.31, unsynchronized: 8 strands x 60 RGB pixels, 2 strands per
+  // universe at channel 1 and 181 (channels 361-512 unused)
+  const uint32_t strandLen = 60, numPixels = strandLen * 8;
+  std::vector<uint8_t> pixels(numPixels * 3), expect(numPixels * 3);
+  Adafruit_NeoPXL8DMX dmx(pixels.data(), numPixels);
+  bool ok = true;
+  for (uint16_t s = 0; s < 8; s++)
+    ok &= dmx.map(1 + s / 2, 1 + (s & 1) * 180, s * strandLen, strandLen);
+  check(ok, "map strands");
+  check(!dmx.map(1, 400, 0, 60), "reject range past channel 512");
+
+  uint8_t dmxData[4][512];
+  uint8_t seq[4] = {0, 0, 0, 0}; // Per universe
+  uint32_t shows = 0, early = 0;
+  for (int frame = 0; frame < 20; frame++) {
+    for (int u = 0; u < 4; u++) {
+      for (int c = 0; c < 512; c++)
+        dmxData[u][c] = frame * 7 + u * 31 + c;
+      for (int h = 0; h < 2; h++) // Each universe holds 2 strands
+        memcpy(&expect[(u * 2 + h) * strandLen * 3], &dmxData[u][h * 180],
+               strandLen * 3);
+      if ((frame == 5) && (u == 2)) {
+        seq[u]++; // Lose packet: partial frame shows when universe 1
+        continue; // repeats, in the next frame
+      }
+      neopxl8_dmx_result_t r = loop_packet(
+          tx, rx, to, dmx, e131(u + 1, seq[u]++, 0, dmxData[u], 512));
+      if (r == NEOPXL8_DMX_SHOW) {
+        shows++;
+        if (u != 3) {
+          if ((frame != 6) || u)
+            early++;
+        } else if (pixels != expect) {
+          ok = false;
+        }
+      }
+    }
+  }
+  check(ok && !early && (shows == 20), "E1.31 frames complete and exact");
+  check(dmx.getLost(3) == 1, "E1.31 lost packet counted");
+  // Late packet (sequence behind) is discarded
+  std::vector<uint8_t> before = pixels;
+  memset(dmxData[0], 0xEE, 512);
+  loop_packet(tx, rx, to, dmx, e131(1, seq[0] - 10, 0, dmxData[0], 512));
+  check((pixels == before) && (dmx.getLost(1) == 1), "E1.31 late packet");
+
+  // E1.31 synchronized: shown only on sync packet
+  uint32_t dataShows = 0;
+  shows = 0;
+  for (int frame = 0; frame < 10; frame++) {
+    for (int u = 0; u < 4; u++) {
+      memset(dmxData[u], frame, 512);
+      if (loop_packet(tx, rx, to, dmx,
+                      e131(u + 1, seq[u]++, 7999, dmxData[u], 512)) ==
+          NEOPXL8_DMX_SHOW)
+        dataShows++;
+    }
+    if (loop_packet(tx, rx, to, dmx, e131(0, frame, 7999, NULL, 0)) ==
+        NEOPXL8_DMX_SHOW)
+      shows++;
+  }
+  // First frame shows on completion, before the first sync is seen
+  check((shows == 10) && (dataShows == 1) && dmx.isSynced() &&
+            (pixels[0] == 9),
+        "E1.31 sync");
+  // Sync stops: falls back to showing complete frames
+  dataShows = 0;
+  for (int i = 0; i < 40; i++) {
+    if (loop_packet(tx, rx, to, dmx,
+                    e131(i % 4 + 1, seq[i % 4]++, 0, dmxData[i % 4], 512)) ==
+        NEOPXL8_DMX_SHOW)
+      dataShows++;
+  }
+  check(!dmx.isSynced() && (dataShows == 10), "E1.31 sync address 0");
+
+  // Art-Net into a 16-bit (NeoPXL8HDR-style) RGBW buffer, universe 0 at
+  // pixel 10 and universe 1 channels 5-12 at pixel 0, with ArtSync
+  std::vector<uint16_t> hdr(20 * 4);
+  Adafruit_NeoPXL8DMX dmx16(hdr.data(), 20, 4);
+  check(dmx16.mapUniverses(0, 10, 10) && dmx16.map(1, 5, 0, 2),
+        "map Art-Net");
+  for (int c = 0; c < 512; c++)
+    dmxData[0][c] = dmxData[1][c] = c;
+  loop_packet(tx, rx, to, dmx16, artnet(0, 254, dmxData[0], 40));
+  loop_packet(tx, rx, to, dmx16, artnet(1, 1, dmxData[1], 12));
+  neopxl8_dmx_result_t r = loop_packet(tx, rx, to, dmx16,
+                                       artnet(0, 0, NULL, 0));
+  check((r == NEOPXL8_DMX_SHOW) && (hdr[0] == 4 * 257) &&
+            (hdr[7] == 11 * 257) && (hdr[8] == 0) && (hdr[40] == 0) &&
+            (hdr[79] == 39 * 257),
+        "Art-Net data and ArtSync");
+  // Sequence wraps 255 -> 1 with no loss, 1 -> 3 loses one
+  for (uint8_t s : {255, 1, 3})
+    loop_packet(tx, rx, to, dmx16, artnet(0, s, dmxData[0], 40));
+  check((dmx16.getLost(0) == 1) && (dmx16.getLost(1) == 0) &&
+            (dmx16.getPackets(0) == 4),
+        "Art-Net sequence");
+  check(dmx16.parse((const uint8_t *)"Art-Net", 8) == NEOPXL8_DMX_NONE,
+        "Reject truncated packet");
+
+  close(tx);
+  close(rx);
+  printf(failures ? "FAIL\n" : "ALL PASS\n");
+  return failures ? 1 : 0;
+}
+
+// MAIN --------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  int pixels = 1360, universe = 1, channels = 3;
+  bool listen = false, test = false;
+  const char *pcap = NULL;
+
+  static const struct option opts[] = {
+      {"pixels", required_argument, NULL, 'n'},
+      {"universe", required_argument, NULL, 'u'},
+      {"channels", required_argument, NULL, 'c'},
+      {"listen", no_argument, NULL, 'l'},
+      {"pcap", required_argument, NULL, 'p'},
+      {"selftest", no_argument, NULL, 's'},
+      {NULL, 0, NULL, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "n:u:c:lp:s", opts, NULL)) != -1) {
+    switch (c) {
+    case 'n':
+      pixels = atoi(optarg);
+      break;
+    case 'u':
+      universe = atoi(optarg);
+      break;
+    case 'c':
+      channels = atoi(optarg);
+      break;
+    case 'l':
+      listen = true;
+      break;
+    case 'p':
+      pcap = optarg;
+      break;
+    case 's':
+      test = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (test)
+    return selftest();
+  if ((pixels < 1) || (channels < 3) || (channels > 4) || (universe < 0) ||
+      (!listen == !pcap))
+    usage(argv[0]);
+
+  std::vector<uint8_t> buf(pixels * channels);
+  Adafruit_NeoPXL8DMX dmx(buf.data(), pixels, channels);
+  if (!dmx.mapUniverses(universe, 0, pixels)) {
+    fprintf(stderr, "Can't map pixels\n");
+    return 1;
+  }
+  uint16_t perUniverse = NEOPXL8_DMX_CHANNELS / channels;
+  uint16_t count = (pixels + perUniverse - 1) / perUniverse;
+  return listen ? listen_udp(dmx, universe, count)
+                : replay_pcap(dmx, pcap, universe, count);
+}
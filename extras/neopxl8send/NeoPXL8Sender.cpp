@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+#include "NeoPXL8Sender.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+NeoPXL8Sender::NeoPXL8Sender(uint32_t numPixels, uint32_t keyframe)
+    : num_pixels(numPixels), keyframe(keyframe), prev(numPixels * 3),
+      zero(numPixels * 3),
+      packet(sizeof(neopxl8_stream_header_t) + numPixels * 3 + 4),
+      work(numPixels * 3) {}
+
+NeoPXL8Sender::~NeoPXL8Sender() { close(); }
+
+bool NeoPXL8Sender::open(const char *path) {
+  close();
+  int f = ::open(path, O_RDWR | O_NOCTTY);
+  if (f < 0)
+    return false;
+  // Raw 8-bit mode, no echo or line processing. Baud rate is not set;
+  // it has no effect on USB CDC devices.
+  struct termios t;
+  if (!tcgetattr(f, &t)) {
+    cfmakeraw(&t);
+    t.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(f, TCSANOW, &t);
+  }
+  fd = f;
+  own_fd = true;
+  force_key = true;
+  return true;
+}
+
+void NeoPXL8Sender::attach(int f) {
+  close();
+  fd = f;
+  force_key = true;
+}
+
+void NeoPXL8Sender::close(void) {
+  if (own_fd && (fd >= 0))
+    ::close(fd);
+  fd = -1;
+  own_fd = false;
+}
+
+// Check for NAK bytes from the device (anything else is ignored)
+void NeoPXL8Sender::poll_nak(void) {
+  struct pollfd p = {fd, POLLIN, 0};
+  uint8_t buf[64];
+  while ((poll(&p, 1, 0) > 0) && (p.revents & POLLIN)) {
+    ssize_t n = read(fd, buf, sizeof buf);
+    if (n <= 0)
+      break;
+    for (ssize_t i = 0; i < n; i++) {
+      if (buf[i] == NEOPXL8_STREAM_NAK) {
+        naks++;
+        force_key = true;
+      }
+    }
+  }
+}
+
+bool NeoPXL8Sender::write_all(const uint8_t *data, size_t len) {
+  while (len) {
+    ssize_t n = write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += n;
+    len -= n;
+    bytes += n;
+  }
+  return true;
+}
+
+bool NeoPXL8Sender::send(const uint8_t *rgb, uint32_t usec) {
+  if (fd < 0)
+    return false;
+  poll_nak();
+
+  uint32_t frameBytes = num_pixels * 3;
+  if (keyframe && (since_key >= keyframe))
+    force_key = true;
+
+  // Smallest of RAW, KEY and (unless keyframe needed) DELTA
+  neopxl8_stream_header_t *h = (neopxl8_stream_header_t *)packet.data();
+  uint8_t *payload = &packet[sizeof *h];
+  h->type = NEOPXL8_FRAME_RAW;
+  h->size = frameBytes;
+  uint32_t len = neopxl8_compress(rgb, zero.data(), num_pixels, payload,
+                                  frameBytes - 1);
+  if (len) {
+    h->type = NEOPXL8_FRAME_KEY;
+    h->size = len;
+  }
+  if (!force_key && (len = neopxl8_compress(rgb, prev.data(), num_pixels,
+                                            work.data(), h->size - 1))) {
+    h->type = NEOPXL8_FRAME_DELTA;
+    h->size = len;
+    memcpy(payload, work.data(), len);
+  }
+  if (h->type == NEOPXL8_FRAME_RAW)
+    memcpy(payload, rgb, frameBytes);
+  if (h->type == NEOPXL8_FRAME_DELTA) {
+    since_key++;
+  } else {
+    keys++;
+    since_key = 1;
+    force_key = false;
+  }
+
+  h->sync[0] = NEOPXL8_STREAM_SYNC0;
+  h->sync[1] = NEOPXL8_STREAM_SYNC1;
+  h->version = NEOPXL8_STREAM_VERSION;
+  h->seq = seq++;
+  h->reserved = 0;
+  h->usec = usec;
+  uint32_t total = sizeof *h + h->size;
+  uint32_t crc = neopxl8_crc32(0, &packet[2], total - 2);
+  for (int i = 0; i < 4; i++)
+    packet[total++] = crc >> (i * 8);
+
+  memcpy(prev.data(), rgb, frameBytes);
+  frames++;
+  return write_all(packet.data(), total);
+}
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// NeoPXL8Sender: host-side (Linux, etc.) sender for the NeoPXL8 binary
+// stream protocol (see Adafruit_NeoPXL8Video.h and the VideoSerial
+// example). THIS IS HOST COMPUTER CODE, NOT ARDUINO CODE.
+
+#pragma once
+
+#include <Adafruit_NeoPXL8Video.h>
+#include <vector>
+
+/*!
+  @brief  Sends RGB frames over a serial device (or any file descriptor)
+          as NeoPXL8 stream packets. Each frame is sent as whichever of a
+          RAW, KEY or DELTA packet is smallest; DELTA is not used at
+          keyframe intervals or after the receiver sends a NAK, so the
+          receiver can recover from lost or corrupted data.
+*/
+class NeoPXL8Sender {
+public:
+  /*!
+    @brief  Sender constructor.
+    @param  numPixels  Pixels per frame (3 bytes each, RGB order, any
+                       gamma correction already applied).
+    @param  keyframe   Keyframe interval in frames, 0 = only as needed.
+  */
+  NeoPXL8Sender(uint32_t numPixels, uint32_t keyframe = 30);
+  ~NeoPXL8Sender();
+
+  /*!
+    @brief  Open serial device in raw mode.
+    @param  path  Device, e.g. "/dev/ttyACM0".
+    @return true on success, false on error (see errno).
+  */
+  bool open(const char *path);
+
+  /*!
+    @brief  Use an already-open file descriptor (e.g. pty or socket).
+            It is not closed by the sender.
+    @param  fd  File descriptor.
+  */
+  void attach(int fd);
+
+  /*!
+    @brief  Close device, if opened by open().
+  */
+  void close(void);
+
+  /*!
+    @brief  Send one frame.
+    @param  rgb   numPixels * 3 bytes.
+    @param  usec  Display interval after the previous frame, 0 = now.
+    @return true on success, false on write error.
+  */
+  bool send(const uint8_t *rgb, uint32_t usec);
+
+  /*!
+    @brief  Make the next frame a keyframe.
+  */
+  void requestKeyframe(void) { force_key = true; }
+
+  uint32_t frames = 0;  ///< Packets sent
+  uint32_t keys = 0;    ///< Of which, RAW or KEY frames
+  uint32_t naks = 0;    ///< NAKs received from device
+  uint64_t bytes = 0;   ///< Total bytes written
+
+private:
+  bool write_all(const uint8_t *data, size_t len);
+  void poll_nak(void);
+
+  int fd = -1;                 ///< Output file descriptor
+  bool own_fd = false;         ///< If set, fd is closed by close()
+  bool force_key = true;       ///< If set, next frame is RAW or KEY
+  uint8_t seq = 0;             ///< Next packet sequence number
+  uint32_t num_pixels;         ///< Pixels per frame
+  uint32_t keyframe;           ///< Keyframe interval
+  uint32_t since_key = 0;      ///< Frames since last keyframe
+  std::vector<uint8_t> prev;   ///< Last frame sent
+  std::vector<uint8_t> zero;   ///< All-black frame, for KEY compression
+  std::vector<uint8_t> packet; ///< Packet assembly buffer
+  std::vector<uint8_t> work;   ///< Compression buffer
+};
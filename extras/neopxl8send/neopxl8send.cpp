@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// neopxl8send: stream movie2msc .bin video (see extras/Processing) to a
+// board running the VideoSerial example, using the NeoPXL8 binary stream
+// protocol (compressed frames with CRC, see Adafruit_NeoPXL8Video.h).
+// Gamma and brightness are applied here, the board only decodes and
+// displays. Frame timing comes from the .bin file; the board paces
+// playback and USB flow control keeps this program from running ahead.
+// THIS IS A HOST COMPUTER PROGRAM, NOT ARDUINO CODE. Build with:
+//
+//   g++ -O2 -I../.. -pthread -o neopxl8send neopxl8send.cpp NeoPXL8Sender.cpp
+//
+// Run without arguments for usage. "neopxl8send --selftest" runs the
+// sender against Adafruit_NeoPXL8Receiver over a pseudo-terminal, with
+// deliberate data corruption, and exits nonzero on any mismatch.
+
+#include "NeoPXL8Sender.h"
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] -d device input.bin\n"
+          "       %s [options] --selftest\n"
+          "  -d, --device PATH    Serial device, e.g. /dev/ttyACM0\n"
+          "  -w, --width N        LED matrix width (default 30)\n"
+          "  -h, --height N       LED matrix height (default 16)\n"
+          "  -g, --gamma F        Gamma correction (default 2.6, 1 = off)\n"
+          "  -b, --brightness N   Brightness, 0-255 (default 255)\n"
+          "  -k, --keyframe N     Keyframe interval (default 30)\n"
+          "  -l, --loop           Repeat video until interrupted\n"
+          "  -s, --selftest       Loopback test over a pseudo-terminal\n",
+          prog, prog);
+  exit(1);
+}
+
+// SELF-TEST ---------------------------------------------------------------
+
+// Receiving end of loopback test: reads from pty slave, corrupts some of
+// the data (one byte flipped, or a run of bytes lost, at intervals) and
+// checks every decoded frame against the original.
+
+struct loopback_t {
+  int fd;                             ///< pty slave
+  uint32_t numPixels;                 ///< Pixels per frame
+  const std::vector<uint8_t> *frames; ///< Source frames, concatenated
+  std::atomic<uint64_t> received{0};  ///< Bytes read from pty
+  std::atomic<bool> stop{false};      ///< Set by sender when finished
+  uint32_t decoded = 0, mismatches = 0, naks = 0, errors = 0;
+};
+
+static void *loopback_thread(void *arg) {
+  loopback_t *lb = (loopback_t *)arg;
+  uint32_t frameBytes = lb->numPixels * 3;
+  std::vector<uint8_t> frame(frameBytes), packet(frameBytes * 2);
+  Adafruit_NeoPXL8Receiver rx(frame.data(), frameBytes, packet.data(),
+                              frameBytes, &packet[frameBytes]);
+  uint8_t buf[1000];
+  uint64_t pos = 0;
+  struct pollfd p = {lb->fd, POLLIN, 0};
+
+  while (!lb->stop) {
+    if (poll(&p, 1, 10) <= 0)
+      continue;
+    ssize_t n = read(lb->fd, buf, sizeof buf);
+    if (n <= 0)
+      break;
+    lb->received += n;
+    const uint8_t *data = buf;
+    // Damage the stream now and then: flip a bit every ~50 KB, drop 100
+    // bytes every ~170 KB (at least once each in the default test)
+    for (ssize_t i = 0; i < n; i++) {
+      if (((pos + i) % 49999) == 25000)
+        buf[i] ^= 0x10;
+    }
+    if (((pos + n) / 170003) != (pos / 170003) && (n > 100)) {
+      data += 100;
+      n -= 100;
+      pos += 100;
+    }
+    pos += n;
+    while (n > 0) {
+      uint32_t used = rx.feed(data, n);
+      data += used;
+      n -= used;
+      uint32_t index;
+      if (rx.available(&index)) { // usec field carries frame index
+        lb->decoded++;
+        if (memcmp(frame.data(), &(*lb->frames)[index * frameBytes],
+                   frameBytes))
+          lb->mismatches++;
+      }
+      if (rx.nak()) {
+        uint8_t nak = NEOPXL8_STREAM_NAK;
+        if (write(lb->fd, &nak, 1) == 1)
+          lb->naks++;
+      }
+    }
+  }
+  lb->errors = rx.getErrors();
+  return NULL;
+}
+
+static int selftest(int width, int height, uint32_t keyframe) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((master < 0) || grantpt(master) || unlockpt(master)) {
+    perror("pty");
+    return 1;
+  }
+  int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  if (slave < 0) {
+    perror(ptsname(master));
+    return 1;
+  }
+  struct termios t;
+  tcgetattr(slave, &t);
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+
+  // Test video: moving gradient over half the image (deltas), random
+  // noise every so often (raw frames), the rest static or black
+  uint32_t numPixels = width * height, frameBytes = numPixels * 3;
+  const uint32_t numFrames = 600;
+  std::vector<uint8_t> frames(numFrames * frameBytes);
+  srand(1);
+  for (uint32_t f = 0; f < numFrames; f++) {
+    uint8_t *rgb = &frames[f * frameBytes];
+    for (uint32_t i = 0; i < numPixels; i++) {
+      int x = i % width, y = i / width;
+      if ((f % 97) == 50) {
+        rgb[i * 3] = rand();
+        rgb[i * 3 + 1] = rand();
+        rgb[i * 3 + 2] = rand();
+      } else if (y < height / 2) {
+        rgb[i * 3] = (x + f) * 8;
+        rgb[i * 3 + 1] = y * 16;
+        rgb[i * 3 + 2] = ((x + f) & 8) ? 255 : 0;
+      } else if (x < width / 2) {
+        rgb[i * 3] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = 40;
+      }
+    }
+  }
+
+  loopback_t lb;
+  lb.fd = slave;
+  lb.numPixels = numPixels;
+  lb.frames = &frames;
+  pthread_t thread;
+  pthread_create(&thread, NULL, loopback_thread, &lb);
+
+  NeoPXL8Sender sender(numPixels, keyframe);
+  sender.attach(master);
+  bool ok = true;
+  for (uint32_t f = 0; ok && (f < numFrames); f++) {
+    ok = sender.send(&frames[f * frameBytes], f);
+    if (!(f % 20))
+      usleep(2000); // Let NAKs come back now and then
+  }
+  while (ok && (lb.received < sender.bytes))
+    usleep(1000);
+  lb.stop = true;
+  pthread_join(thread, NULL);
+  close(slave);
+  close(master);
+
+  printf("Sent %u frames (%u keyframes), %llu bytes (raw would be %llu)\n",
+         (unsigned)sender.frames, (unsigned)sender.keys,
+         (unsigned long long)sender.bytes,
+         (unsigned long long)numFrames * frameBytes);
+  printf("Received %u frames, %u mismatched, %u errors, %u NAKs (%u seen)\n",
+         (unsigned)lb.decoded, (unsigned)lb.mismatches, (unsigned)lb.errors,
+         (unsigned)lb.naks, (unsigned)sender.naks);
+  // Every decoded frame must be exact, errors must have been detected and
+  // recovered from (most frames still shown), and NAKs must round-trip
+  if (!ok || lb.mismatches || !lb.errors || !sender.naks ||
+      (lb.decoded < numFrames * 3 / 4)) {
+    printf("FAIL\n");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
+
+// MAIN --------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  int width = 30, height = 16, brightness = 255, keyframe = 30;
+  bool loop = false, test = false;
+  const char *device = NULL;
+  double gamma = 2.6;
+
+  static const struct option opts[] = {
+      {"device", required_argument, NULL, 'd'},
+      {"width", required_argument, NULL, 'w'},
+      {"height", required_argument, NULL, 'h'},
+      {"gamma", required_argument, NULL, 'g'},
+      {"brightness", required_argument, NULL, 'b'},
+      {"keyframe", required_argument, NULL, 'k'},
+      {"loop", no_argument, NULL, 'l'},
+      {"selftest", no_argument, NULL, 's'},
+      {NULL, 0, NULL, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "d:w:h:g:b:k:ls", opts, NULL)) != -1) {
+    switch (c) {
+    case 'd':
+      device = optarg;
+      break;
+    case 'w':
+      width = atoi(optarg);
+      break;
+    case 'h':
+      height = atoi(optarg);
+      break;
+    case 'g':
+      gamma = atof(optarg);
+      break;
+    case 'b':
+      brightness = atoi(optarg);
+      break;
+    case 'k':
+      keyframe = atoi(optarg);
+      break;
+    case 'l':
+      loop = true;
+      break;
+    case 's':
+      test = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if ((width < 1) || (height < 1) || (keyframe < 0))
+    usage(argv[0]);
+  if (test)
+    return selftest(width, height, keyframe);
+  if (!device || ((argc - optind) != 1))
+    usage(argv[0]);
+
+  // Gamma and brightness are merged into one table
+  uint8_t lut[256];
+  for (int i = 0; i < 256; i++) {
+    double v = (gamma > 0.0) ? pow(i / 255.0, gamma) : i / 255.0;
+    lut[i] = (int)(v * brightness + 0.5);
+  }
+
+  FILE *in = fopen(argv[optind], "rb");
+  if (!in) {
+    perror(argv[optind]);
+    return 1;
+  }
+  uint32_t numPixels = width * height;
+  NeoPXL8Sender sender(numPixels, keyframe);
+  if (!sender.open(device)) {
+    perror(device);
+    return 1;
+  }
+
+  std::vector<uint8_t> image(numPixels * 3);
+  uint8_t rec[5];
+  for (;;) {
+    if (fread(rec, 1, 5, in) != 5) {
+      if (!loop || !sender.frames)
+        break;
+      rewind(in);
+      continue;
+    }
+    uint32_t size = rec[1] | (rec[2] << 8), usec = rec[3] | (rec[4] << 8);
+    if (rec[0] == '%') { // Audio chunk, skip
+      fseek(in, size * 2, SEEK_CUR);
+      continue;
+    } else if (rec[0] != '*') {
+      fprintf(stderr, "Unknown record in input, stopping\n");
+      break;
+    }
+    // As in VideoMSC, excess pixels are ignored and missing ones are 0
+    std::fill(image.begin(), image.end(), 0);
+    uint32_t bytes = size * 3, n = std::min<uint32_t>(bytes, image.size());
+    if (fread(image.data(), 1, n, in) != n) {
+      fprintf(stderr, "Truncated frame in input, stopping\n");
+      break;
+    }
+    if (bytes > n)
+      fseek(in, bytes - n, SEEK_CUR);
+    for (auto &v : image)
+      v = lut[v];
+    if (!sender.send(image.data(), usec)) {
+      perror(device);
+      return 1;
+    }
+  }
+  fclose(in);
+  printf("%u frames (%u keyframes, %u NAKs), %llu bytes\n",
+         (unsigned)sender.frames, (unsigned)sender.keys,
+         (unsigned)sender.naks, (unsigned long long)sender.bytes);
+  return 0;
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+#include "NeoPXL8Decoder.h"
+#include <string.h>
+
+NeoPXL8Decoder::NeoPXL8Decoder(uint8_t stride, const uint32_t *m, uint8_t n)
+    : stride(stride), lanes((n > 16) ? 32 : (n > 8) ? 16 : 8),
+      word_size(lanes / 8) {
+  for (uint8_t i = 0; i < 32; i++)
+    masks[i] = (i >= lanes) ? 0 : m ? m[i] : (1UL << i);
+}
+
+// Little-endian DMA word at index i
+uint32_t NeoPXL8Decoder::word(const uint8_t *buf, size_t i) const {
+  const uint8_t *p = &buf[i * word_size];
+  uint32_t w = 0;
+  for (uint8_t b = word_size; b--;)
+    w = (w << 8) | p[b];
+  return w;
+}
+
+bool NeoPXL8Decoder::decode(const uint8_t *buf, size_t len) {
+  uint32_t active = 0; // All strand bits in use
+  for (uint8_t i = 0; i < lanes; i++)
+    active |= masks[i];
+
+  // SAMD lead-in: zero bytes before the first triplet (whose high phase
+  // word is always all ones, so there's no ambiguity with actual data).
+  size_t words = len / word_size, lead = 0;
+  if (stride > 1) {
+    while ((lead < words) && !(word(buf, lead) & active))
+      lead++;
+  }
+  leadBytes = lead * word_size;
+  buf += leadBytes;
+  len -= leadBytes;
+  words -= lead;
+
+  strand_bytes = words / (8 * stride);
+  uint32_t bits = strand_bytes * 8;
+  trailBytes = len - bits * stride * word_size;
+  framingErrors = 0;
+  firstError = 0;
+  for (uint8_t i = 0; i < lanes; i++)
+    strands[i].assign(strand_bytes, 0);
+
+  // Data word is first of stride 1, middle of triplet for stride 3
+  for (uint32_t b = 0; b < bits; b++) {
+    size_t t = b * stride;
+    if (stride > 1) {
+      // High phase must be set and low phase clear on all active strands
+      if (((word(buf, t) & active) != active) ||
+          (word(buf, t + 2) & active)) {
+        if (!framingErrors++)
+          firstError = leadBytes + t * word_size;
+      }
+    }
+    uint32_t d = word(buf, t + (stride > 1));
+    for (uint8_t i = 0; i < lanes; i++) {
+      if (d & masks[i])
+        strands[i][b / 8] |= 0x80 >> (b & 7); // MSB first
+    }
+  }
+
+  return strand_bytes && !framingErrors;
+}
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// NeoPXL8Decoder: host-side (Linux, etc.) decoder for captured NeoPXL8 DMA
+// buffers, recovering the exact byte stream each strand would latch.
+// THIS IS HOST COMPUTER CODE, NOT ARDUINO CODE.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*!
+  @brief  Decodes a NeoPXL8 DMA buffer, as staged by show() on any of the
+          supported platforms, back into per-strand NeoPixel data. Each
+          strand's output is the bit-exact sequence of bytes (color order
+          as on the wire, brightness applied) its LEDs would receive.
+          Buffer layouts are:
+          - RP2040/RP2350: one byte per NeoPixel bit (stride 1), each
+            strand on one bit of the byte.
+          - SAMD and ESP32S3: one 0xFF/data/0x00 triplet per NeoPixel bit
+            (stride 3); high, data and low phases of the waveform.
+          - SAMD: the transfer begins with a run of zero bytes (see
+            EXTRASTARTBYTES in Adafruit_NeoPXL8.cpp) to let DMA timing
+            settle. These are skipped, and counted, for stride-3 buffers.
+          - ESP32S3 with 16 lanes: as above, but each element of the
+            triplet is a 16-bit (little-endian) word.
+          - SAMD51 with 16 or 32 lanes (PORT DMA): one 16- or 32-bit word
+            per NeoPixel bit (stride 1), data phase only.
+*/
+class NeoPXL8Decoder {
+public:
+  /*!
+    @brief  Decoder constructor.
+    @param  stride  DMA buffer words per NeoPixel bit: 1 for RP2040 and
+                    SAMD51 PORT DMA, 3 for SAMD and ESP32S3 (as
+                    NEOPXL8_DMA_BIT_STRIDE).
+    @param  masks   Optional array of 'lanes' bitmasks, the DMA word bit
+                    for each strand (0 = strand unused). These correspond
+                    to the library's internal per-pin bitmask[] table,
+                    which depends on the pins passed to the constructor
+                    (e.g. on RP2040, 1 << (pin - lowest pin)). If NULL,
+                    strand N is bit N.
+    @param  lanes   Strand count, 8 (byte per word), 16 (16-bit words) or
+                    32 (32-bit words).
+  */
+  NeoPXL8Decoder(uint8_t stride, const uint32_t *masks = NULL,
+                 uint8_t lanes = 8);
+
+  /*!
+    @brief  Decode a captured DMA buffer.
+    @param  buf  Captured buffer, starting at dmaBuf (SAMD lead-in bytes
+                 included) or at getStageBuffer() (none).
+    @param  len  Buffer length in bytes. Any partial byte of NeoPixel bits
+                 at the end (e.g. SAMD alignment padding) is ignored.
+    @return true if buffer was decoded with no framing errors, false if
+            too short or any high/low phase byte was wrong on an active
+            strand (data is still decoded in that case).
+  */
+  bool decode(const uint8_t *buf, size_t len);
+
+  /*!
+    @brief  Get decoded data for one strand.
+    @param  n  Strand number, 0 to lanes-1.
+    @return Pointer to getStrandBytes() bytes, or NULL if strand unused.
+  */
+  const uint8_t *getStrand(uint8_t n) const {
+    return ((n < lanes) && masks[n]) ? strands[n].data() : NULL;
+  }
+
+  /*!
+    @brief  Query strand count passed to constructor.
+    @return Lane count, 8, 16 or 32.
+  */
+  uint8_t getLanes(void) const { return lanes; }
+
+  /*!
+    @brief  Query bytes decoded per strand.
+    @return Byte count (pixels per strand times 3 or 4).
+  */
+  uint32_t getStrandBytes(void) const { return strand_bytes; }
+
+  uint32_t leadBytes = 0;     ///< Zero bytes skipped before first bit
+  uint32_t trailBytes = 0;    ///< Bytes ignored after last whole byte
+  uint32_t framingErrors = 0; ///< High/low phase words in error
+  size_t firstError = 0;      ///< Buffer offset of first framing error
+
+private:
+  uint32_t word(const uint8_t *buf, size_t i) const;
+
+  uint8_t stride;                   ///< Buffer words per NeoPixel bit
+  uint8_t lanes;                    ///< Strand count, 8, 16 or 32
+  uint8_t word_size;                ///< Bytes per DMA word
+  uint32_t masks[32];               ///< DMA word bit for each strand
+  uint32_t strand_bytes = 0;        ///< Bytes decoded per strand
+  std::vector<uint8_t> strands[32]; ///< Decoded data per strand
+};
@@ -0,0 +1,422 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// neopxl8sim: decode a NeoPXL8 DMA buffer captured from a board (e.g. by
+// writing getStageBuffer() to Serial after show()) back to the bytes each
+// strand's LEDs would latch, and optionally render a preview image. Given
+// two captures, compares the decoded data -- e.g. before and after a
+// change to stage(), or from two different platforms -- and exits nonzero
+// if any strand differs.
+// THIS IS A HOST COMPUTER PROGRAM, NOT ARDUINO CODE. Build with:
+//
+//   g++ -O2 -I../.. -o neopxl8sim neopxl8sim.cpp NeoPXL8Decoder.cpp
+//
+// Run without arguments for usage. "neopxl8sim --selftest" checks the
+// decoder against a copy of stage()'s encoding for each platform.
+
+#include "NeoPXL8Decoder.h"
+#include <Adafruit_NeoPXL8Video.h> // For neopxl8_crc32()
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] capture.bin [capture2.bin]\n"
+          "       %s --selftest\n"
+          "  -p, --platform STR   rp2040 (default, also RP2350), samd,\n"
+          "                       samd51port (16/32 lanes) or esp32s3\n"
+          "  -P, --platform2 STR  Platform of 2nd capture (default same)\n"
+          "  -l, --lanes N        Strand count, 8 (default), 16 (ESP32S3\n"
+          "                       16-bit bus, SAMD51) or 32 (SAMD51)\n"
+          "  -m, --masks LIST     DMA bit for each strand, -1 = unused\n"
+          "                       (default 0,1,2,...)\n"
+          "  -c, --channels N     Bytes per pixel, 3 or 4 (default 3)\n"
+          "  -o, --order STR      Color order for preview, e.g. GRB\n"
+          "                       (default), RGBW\n"
+          "  -i, --image FILE     Write preview image (PPM), one row per\n"
+          "                       strand\n"
+          "  -z, --zoom N         Preview pixel size (default 8)\n"
+          "  -r, --raw FILE       Write decoded strands, concatenated\n"
+          "  -d, --dump           Print decoded strands in hex\n"
+          "  -s, --selftest       Encode/decode test, exits nonzero on "
+          "failure\n",
+          prog, prog);
+  exit(1);
+}
+
+static uint8_t platform_stride(const char *name, const char *prog) {
+  if (!strcmp(name, "rp2040") || !strcmp(name, "rp2350") ||
+      !strcmp(name, "samd51port"))
+    return 1;
+  if (!strcmp(name, "samd") || !strcmp(name, "esp32s3"))
+    return 3;
+  usage(prog);
+  return 0;
+}
+
+// SELF-TEST ---------------------------------------------------------------
+
+// Same buffer contents as Adafruit_NeoPXL8::stage() (and spread_bits())
+// for the given stride, plus SAMD lead-in and alignment padding if
+// requested. src is 'lanes' strands of strandBytes each, brightness is
+// 1-256. With 16 or 32 lanes, each DMA word is 16 or 32 bits,
+// little-endian.
+static std::vector<uint8_t> encode(const uint8_t *src, uint32_t strandBytes,
+                                   uint16_t brightness, uint8_t stride,
+                                   const uint32_t *masks, uint8_t lanes,
+                                   uint32_t lead, uint32_t pad) {
+  uint8_t wordSize = lanes / 8;
+  uint32_t words = strandBytes * 8 * stride;
+  std::vector<uint32_t> dma(words, 0);
+  uint32_t first = 0; // Index of first data word
+  if (stride > 1) {
+    for (uint32_t i = 0; i < words; i += 3)
+      dma[i] = 0xFFFFFFFF >> (32 - lanes);
+    first = 1;
+  }
+  for (uint8_t b = 0; b < lanes; b++) {
+    uint32_t mask = masks[b];
+    if (mask) {
+      uint32_t dst = first;
+      for (uint32_t i = 0; i < strandBytes; i++) {
+        uint16_t value = src[b * strandBytes + i] * brightness;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+          if (value & (0x8000 >> bit))
+            dma[dst + bit * stride] |= mask;
+        }
+        dst += 8 * stride;
+      }
+    }
+  }
+  std::vector<uint8_t> buf(lead + words * wordSize + pad, 0);
+  for (uint32_t i = 0; i < words; i++) {
+    for (uint8_t b = 0; b < wordSize; b++)
+      buf[lead + i * wordSize + b] = dma[i] >> (b * 8);
+  }
+  return buf;
+}
+
+static int selftest(void) {
+  static const struct {
+    const char *name;
+    uint8_t stride;
+    uint8_t bpp;
+    uint16_t brightness;
+    uint32_t lead, pad; // As allocated in begin()
+    uint8_t lanes;
+    uint32_t masks[32];
+  } tests[] = {
+      // RP2040, pins 9,8,7,-1,6,12,11,10: 1 << (pin - 6)
+      {"rp2040 GRB", 1, 3, 256, 0, 0, 8, {8, 4, 2, 0, 1, 64, 32, 16}},
+      {"rp2040 RGBW", 1, 4, 100, 0, 0, 8, {1, 2, 4, 8, 16, 32, 64, 128}},
+      // SAMD, TCC pattern generator bits vary by pin
+      {"samd GRB", 3, 3, 256, 24, 3, 8, {2, 1, 0, 128, 4, 8, 64, 32}},
+      {"samd RGBW", 3, 4, 31, 24, 3, 8, {1, 2, 4, 8, 16, 32, 64, 128}},
+      // ESP32S3, LCD_CAM data line N is bit N
+      {"esp32s3 GRB", 3, 3, 256, 0, 3, 8, {1, 2, 4, 8, 16, 32, 64, 128}},
+      {"esp32s3 RGBW", 3, 4, 200, 0, 3, 8, {1, 2, 4, 8, 0, 0, 64, 128}},
+      // ESP32S3 16-bit bus; some upper lanes unused
+      {"esp32s3 x16", 3, 3, 256, 0, 3, 16,
+       {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 0, 2048, 4096, 0, 16384,
+        32768}},
+      // SAMD51 PORT DMA, PORT bit of each pin (within half for 16 lanes)
+      {"samd51 x16", 1, 3, 256, 0, 0, 16,
+       {1 << 9, 1 << 8, 1 << 7, 1 << 6, 0, 1 << 4, 1 << 3, 1 << 2, 1 << 15,
+        1 << 14, 1 << 13, 1 << 12, 1 << 11, 1 << 10, 0, 1}},
+      {"samd51 x32", 1, 4, 64, 0, 0, 32,
+       {1UL << 31, 1 << 30, 1 << 29, 1 << 28, 1 << 27, 1 << 26, 1 << 25,
+        1 << 24, 1 << 23, 1 << 22, 1 << 21, 1 << 20, 1 << 19, 1 << 18, 0,
+        1 << 16, 1 << 15, 1 << 14, 1 << 13, 1 << 12, 1 << 11, 1 << 10,
+        1 << 9, 1 << 8, 1 << 7, 1 << 6, 1 << 5, 1 << 4, 1 << 3, 1 << 2,
+        1 << 1, 1}},
+  };
+  const uint32_t pixels = 37;
+  int failures = 0;
+  srand(1);
+
+  for (const auto &t : tests) {
+    uint32_t strandBytes = pixels * t.bpp;
+    std::vector<uint8_t> src(strandBytes * t.lanes),
+        expect(strandBytes * t.lanes);
+    for (uint32_t i = 0; i < src.size(); i++) {
+      src[i] = (i < 8) ? (0xFF >> i) : rand(); // Some known edge values
+      expect[i] = (src[i] * t.brightness) >> 8;
+    }
+    std::vector<uint8_t> buf =
+        encode(src.data(), strandBytes, t.brightness, t.stride, t.masks,
+               t.lanes, t.lead, t.pad);
+
+    NeoPXL8Decoder dec(t.stride, t.masks, t.lanes);
+    bool ok = dec.decode(buf.data(), buf.size()) &&
+              (dec.getStrandBytes() == strandBytes) &&
+              (dec.leadBytes == t.lead) && (dec.trailBytes == t.pad);
+    for (uint8_t s = 0; ok && (s < t.lanes); s++) {
+      const uint8_t *d = dec.getStrand(s);
+      if (t.masks[s])
+        ok = d && !memcmp(d, &expect[s * strandBytes], strandBytes);
+      else
+        ok = !d;
+    }
+
+    // Corrupt one high phase bit and one low phase bit on an active
+    // strand; both must be reported, and data must still decode.
+    bool framing = true;
+    if (ok && (t.stride > 1)) {
+      uint8_t m = t.masks[0], w = t.lanes / 8;
+      uint32_t at = t.lead + 300 * w;
+      buf[at] &= ~m;
+      buf[at + 5 * w] |= m;
+      framing = !dec.decode(buf.data(), buf.size()) &&
+                (dec.framingErrors == 2) && (dec.firstError == at) &&
+                !memcmp(dec.getStrand(0), expect.data(), strandBytes);
+    }
+
+    printf("%-14s %s\n", t.name, (ok && framing) ? "OK" : "FAIL");
+    failures += !(ok && framing);
+  }
+
+  printf(failures ? "FAIL\n" : "PASS\n");
+  return failures ? 1 : 0;
+}
+
+// OUTPUT ------------------------------------------------------------------
+
+static bool read_file(const char *path, std::vector<uint8_t> &buf) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof chunk, f)) > 0)
+    buf.insert(buf.end(), chunk, chunk + n);
+  fclose(f);
+  return true;
+}
+
+static void print_summary(const char *path, const NeoPXL8Decoder &dec,
+                          uint8_t bpp) {
+  printf("%s: %u bytes/strand (%u pixels), %u lead-in, %u trailing\n", path,
+         (unsigned)dec.getStrandBytes(),
+         (unsigned)(dec.getStrandBytes() / bpp), (unsigned)dec.leadBytes,
+         (unsigned)dec.trailBytes);
+  if (dec.framingErrors)
+    printf("  %u framing errors, first at offset %u\n",
+           (unsigned)dec.framingErrors, (unsigned)dec.firstError);
+  for (uint8_t s = 0; s < dec.getLanes(); s++) {
+    const uint8_t *d = dec.getStrand(s);
+    if (d)
+      printf("  strand %u: crc32 %08x\n", s,
+             (unsigned)neopxl8_crc32(0, d, dec.getStrandBytes()));
+  }
+}
+
+static void dump(const NeoPXL8Decoder &dec, uint8_t bpp) {
+  for (uint8_t s = 0; s < dec.getLanes(); s++) {
+    const uint8_t *d = dec.getStrand(s);
+    if (!d)
+      continue;
+    printf("strand %u:", s);
+    for (uint32_t i = 0; i < dec.getStrandBytes(); i++) {
+      if (!(i % (bpp * 8)))
+        printf("\n  %5u:", (unsigned)(i / bpp));
+      printf("%s%02X", (i % bpp) ? "" : " ", d[i]);
+    }
+    printf("\n");
+  }
+}
+
+static bool write_raw(const char *path, const NeoPXL8Decoder &dec) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  std::vector<uint8_t> zero(dec.getStrandBytes(), 0);
+  for (uint8_t s = 0; s < dec.getLanes(); s++) {
+    const uint8_t *d = dec.getStrand(s);
+    fwrite(d ? d : zero.data(), 1, zero.size(), f); // Unused strand = 0
+  }
+  fclose(f);
+  return true;
+}
+
+// Binary PPM, one row of LEDs per strand. Values are shown as sent (any
+// gamma correction included); white, if present, is added to R, G and B.
+static bool write_ppm(const char *path, const NeoPXL8Decoder &dec,
+                      uint8_t bpp, const int8_t *offset, int zoom) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  uint32_t pixels = dec.getStrandBytes() / bpp, w = pixels * zoom;
+  fprintf(f, "P6\n%u %u\n255\n", (unsigned)w, dec.getLanes() * zoom);
+  std::vector<uint8_t> row(w * 3);
+  for (uint8_t s = 0; s < dec.getLanes(); s++) {
+    const uint8_t *d = dec.getStrand(s);
+    std::fill(row.begin(), row.end(), 0);
+    for (uint32_t p = 0; d && (p < pixels); p++) {
+      const uint8_t *px = &d[p * bpp];
+      int white = (offset[3] >= 0) ? px[offset[3]] : 0;
+      for (int c = 0; c < 3; c++) {
+        int v = px[offset[c]] + white;
+        for (int z = 0; z < zoom; z++)
+          row[(p * zoom + z) * 3 + c] = (v > 255) ? 255 : v;
+      }
+    }
+    for (int z = 0; z < zoom; z++)
+      fwrite(row.data(), 1, row.size(), f);
+  }
+  fclose(f);
+  return true;
+}
+
+// MAIN --------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  const char *platform = "rp2040", *platform2 = NULL, *order = NULL;
+  const char *image = NULL, *raw = NULL;
+  int bpp = 3, zoom = 8, lanes = 8, num_masks = 0;
+  bool hex = false, test = false;
+  uint32_t masks[32];
+  for (int i = 0; i < 32; i++)
+    masks[i] = 1UL << i;
+
+  static const struct option opts[] = {
+      {"platform", required_argument, NULL, 'p'},
+      {"platform2", required_argument, NULL, 'P'},
+      {"lanes", required_argument, NULL, 'l'},
+      {"masks", required_argument, NULL, 'm'},
+      {"channels", required_argument, NULL, 'c'},
+      {"order", required_argument, NULL, 'o'},
+      {"image", required_argument, NULL, 'i'},
+      {"zoom", required_argument, NULL, 'z'},
+      {"raw", required_argument, NULL, 'r'},
+      {"dump", no_argument, NULL, 'd'},
+      {"selftest", no_argument, NULL, 's'},
+      {NULL, 0, NULL, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "p:P:l:m:c:o:i:z:r:ds", opts, NULL)) !=
+         -1) {
+    switch (c) {
+    case 'p':
+      platform = optarg;
+      break;
+    case 'P':
+      platform2 = optarg;
+      break;
+    case 'l':
+      lanes = atoi(optarg);
+      break;
+    case 'm': {
+      char *s = optarg;
+      for (num_masks = 0; *s && (num_masks < 32); num_masks++) {
+        long bit = strtol(s, &s, 0);
+        masks[num_masks] = ((bit >= 0) && (bit < 32)) ? (1UL << bit) : 0;
+        if (*s == ',')
+          s++;
+        else if (*s)
+          usage(argv[0]);
+      }
+    } break;
+    case 'c':
+      bpp = atoi(optarg);
+      break;
+    case 'o':
+      order = optarg;
+      break;
+    case 'i':
+      image = optarg;
+      break;
+    case 'z':
+      zoom = atoi(optarg);
+      break;
+    case 'r':
+      raw = optarg;
+      break;
+    case 'd':
+      hex = true;
+      break;
+    case 's':
+      test = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (test)
+    return selftest();
+  int files = argc - optind;
+  if ((files < 1) || (files > 2) || ((bpp != 3) && (bpp != 4)) ||
+      (zoom < 1) || ((lanes != 8) && (lanes != 16) && (lanes != 32)) ||
+      (num_masks && (num_masks != lanes)))
+    usage(argv[0]);
+
+  // Byte offset of R, G, B and W (-1 = none) within each pixel
+  if (!order)
+    order = (bpp == 4) ? "GRBW" : "GRB";
+  int8_t offset[4] = {-1, -1, -1, -1};
+  if ((int)strlen(order) != bpp)
+    usage(argv[0]);
+  for (int i = 0; i < bpp; i++) {
+    const char *p = strchr("RGBW", order[i] & ~0x20); // Upper case
+    if (!p || !*p || (offset[p - "RGBW"] >= 0))
+      usage(argv[0]);
+    offset[p - "RGBW"] = i;
+  }
+  if ((offset[0] < 0) || (offset[1] < 0) || (offset[2] < 0))
+    usage(argv[0]);
+
+  std::vector<uint8_t> buf;
+  if (!read_file(argv[optind], buf))
+    return 1;
+  NeoPXL8Decoder dec(platform_stride(platform, argv[0]), masks, lanes);
+  dec.decode(buf.data(), buf.size());
+  print_summary(argv[optind], dec, bpp);
+  if (!dec.getStrandBytes())
+    return 1;
+  if (hex)
+    dump(dec, bpp);
+  if (raw && !write_raw(raw, dec))
+    return 1;
+  if (image && !write_ppm(image, dec, bpp, offset, zoom))
+    return 1;
+  int status = dec.framingErrors ? 1 : 0;
+
+  if (files == 2) {
+    std::vector<uint8_t> buf2;
+    if (!read_file(argv[optind + 1], buf2))
+      return 1;
+    NeoPXL8Decoder dec2(
+        platform_stride(platform2 ? platform2 : platform, argv[0]), masks,
+        lanes);
+    dec2.decode(buf2.data(), buf2.size());
+    print_summary(argv[optind + 1], dec2, bpp);
+    if (dec2.framingErrors)
+      status = 1;
+    if (dec2.getStrandBytes() != dec.getStrandBytes()) {
+      printf("Strand lengths differ\n");
+      return 1;
+    }
+    for (uint8_t s = 0; s < lanes; s++) {
+      const uint8_t *a = dec.getStrand(s), *b = dec2.getStrand(s);
+      for (uint32_t i = 0; a && (i < dec.getStrandBytes()); i++) {
+        if (a[i] != b[i]) {
+          printf("Strand %u differs at pixel %u byte %u: %02X vs %02X\n", s,
+                 (unsigned)(i / bpp), (unsigned)(i % bpp), a[i], b[i]);
+          status = 1;
+          break;
+        }
+      }
+    }
+    if (!status)
+      printf("Decoded data identical\n");
+  }
+
+  return status;
+}
@@ -0,0 +1,341 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// neopxl8timing: report the NeoPixel bit timing NeoPXL8 generates on each
+// platform at a given clock (see Adafruit_NeoPXL8Timing.h) and check it
+// against LED chip datasheet limits, e.g. before running an overclocked
+// RP2040, or to see what a timing descriptor passed to begin() actually
+// produces. Exits nonzero if a chip given with -c is out of spec.
+// THIS IS A HOST COMPUTER PROGRAM, NOT ARDUINO CODE. Build with:
+//
+//   g++ -O2 -I../.. -o neopxl8timing neopxl8timing.cpp
+//
+// Run with -h for usage. "neopxl8timing --selftest" checks the model
+// against hand-calculated values for the default configurations.
+
+#include <Adafruit_NeoPXL8Timing.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -p, --platform STR   rp2040 (also RP2350), samd21, samd51,\n"
+          "                       samd51port (16/32 lanes) or esp32s3\n"
+          "                       (default: all, common clocks)\n"
+          "  -f, --clock HZ       CPU clock, rp2040 and samd21 only\n"
+          "                       (default 133000000, 48000000)\n"
+          "  -l, --latch US       setLatchTime() value (default 300)\n"
+          "  -t, --timing STR     begin() timing: 800k (default), 400k or\n"
+          "                       T0H,T1H,PERIOD in nanoseconds\n"
+          "  -c, --chip NAME      Check one chip (default: all)\n"
+          "  -s, --selftest       Check model, exits nonzero on failure\n"
+          "Chips:",
+          prog);
+  for (size_t i = 0; i < NEOPXL8_CHIP_SPECS; i++)
+    fprintf(stderr, " \"%s\"", neopxl8_chip_specs[i].name);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+// Print model and chip checks for one configuration, return number of
+// chips out of spec.
+static int report(const char *title, const neopxl8_waveform_t &w,
+                  const neopxl8_chip_spec_t *only) {
+  printf("%s\n", title);
+  printf("  T0H %6.1f-%-6.1f  T1H %6.1f-%-6.1f  period %6.1f-%-6.1f ns\n",
+         w.t0h[0], w.t0h[1], w.t1h[0], w.t1h[1], w.period[0], w.period[1]);
+  printf("  T0L %6.1f-%-6.1f  T1L %6.1f-%-6.1f  reset  %6.1f us\n", w.t0l[0],
+         w.t0l[1], w.t1l[0], w.t1l[1], w.reset);
+  int fails = 0;
+  for (size_t i = 0; i < NEOPXL8_CHIP_SPECS; i++) {
+    const neopxl8_chip_spec_t *s = &neopxl8_chip_specs[i];
+    if (only && (s != only))
+      continue;
+    uint8_t result = neopxl8_timing_check(&w, s);
+    printf("  %-11s", s->name);
+    if (!result) {
+      printf(" OK\n");
+      continue;
+    }
+    fails++;
+    if (result & NEOPXL8_TIMING_T0H)
+      printf(" T0H (%u-%u)", (unsigned)s->t0h[0], (unsigned)s->t0h[1]);
+    if (result & NEOPXL8_TIMING_T1H)
+      printf(" T1H (%u-%u)", (unsigned)s->t1h[0], (unsigned)s->t1h[1]);
+    if (result & NEOPXL8_TIMING_T0L)
+      printf(" T0L (%u-%u)", (unsigned)s->t0l[0], (unsigned)s->t0l[1]);
+    if (result & NEOPXL8_TIMING_T1L)
+      printf(" T1L (%u-%u)", (unsigned)s->t1l[0], (unsigned)s->t1l[1]);
+    if (result & NEOPXL8_TIMING_RESET)
+      printf(" reset (%u)", (unsigned)s->reset);
+    printf("\n");
+  }
+  return fails;
+}
+
+static int run(const char *platform, uint32_t clock, uint16_t latch,
+               const neopxl8_timing_t *t, const neopxl8_chip_spec_t *only) {
+  neopxl8_waveform_t w;
+  char title[100];
+  if (!strcmp(platform, "rp2040") || !strcmp(platform, "rp2350")) {
+    if (!clock)
+      clock = 133000000;
+    neopxl8_pio_config_t c;
+    if (!neopxl8_timing_rp2040(&w, clock, latch, t) ||
+        !neopxl8_pio_config(&c, clock, t)) {
+      printf("RP2040/RP2350 @ %g MHz: timing not possible\n",
+             clock / 1000000.0);
+      return 1;
+    }
+    snprintf(title, sizeof title,
+             "RP2040/RP2350 @ %g MHz (PIO %u/%u/%u cycles, clkdiv %g)",
+             clock / 1000000.0, c.high, c.data, c.low,
+             neopxl8_pio_clkdiv(c.div));
+  } else if (!strcmp(platform, "samd21") || !strcmp(platform, "samd51")) {
+    // TCC0 runs from F_CPU on SAMD21, from 48 MHz DFLL on SAMD51
+    if (!strcmp(platform, "samd51") || !clock)
+      clock = 48000000;
+    if (!neopxl8_timing_samd(&w, clock, latch, t)) {
+      printf("%s: timing not possible\n",
+             !strcmp(platform, "samd51") ? "SAMD51" : "SAMD21");
+      return 1;
+    }
+    snprintf(title, sizeof title, "%s @ %g MHz TCC clock (PER %u)",
+             !strcmp(platform, "samd51") ? "SAMD51" : "SAMD21",
+             clock / 1000000.0, (unsigned)neopxl8_tcc_period(clock, t->period));
+  } else if (!strcmp(platform, "samd51port")) {
+    neopxl8_port_config_t c;
+    if (!neopxl8_timing_samd_port(&w, 48000000, latch, t) ||
+        !neopxl8_port_config(&c, 48000000, t)) {
+      printf("SAMD51 PORT DMA: timing not possible\n");
+      return 1;
+    }
+    snprintf(title, sizeof title,
+             "SAMD51 PORT DMA @ 48 MHz TCC clock (PER %u, CC %u/%u/%u)",
+             (unsigned)c.per, (unsigned)c.cc[0], (unsigned)c.cc[1],
+             (unsigned)c.cc[2]);
+  } else if (!strcmp(platform, "esp32s3")) {
+    uint16_t num;
+    uint8_t a, b;
+    neopxl8_lcd_divider(240000000, t->period, &num, &a, &b);
+    neopxl8_timing_esp32s3(&w, 240000000, latch, t);
+    snprintf(title, sizeof title, "ESP32-S3 (240 MHz PLL / (%u + %u/%u))",
+             num, b, a);
+  } else {
+    return -1;
+  }
+  return report(title, w, only);
+}
+
+// SELF-TEST ---------------------------------------------------------------
+
+static bool near(float a, float b) { return fabsf(a - b) < 0.1f; }
+
+static int selftest(void) {
+  int failures = 0;
+  neopxl8_waveform_t w;
+  const neopxl8_chip_spec_t *ws2812b = &neopxl8_chip_specs[0];
+
+  // RP2040 at 133 MHz: 133M / 800K / 9 = 18.4722, truncated to 16.8
+  // fixed point = 18 + 120/256 = 18.46875 system clocks per PIO cycle.
+  // T0H is 2 PIO cycles = 36.9375 clocks, so 36 or 37 = 270.7-278.2 ns.
+  // T1H 6 cycles = 110.8 -> 110-111 clocks, period 9 = 166.2 -> 166-167.
+  // Default timing must reproduce the original program and divider.
+  neopxl8_pio_config_t c;
+  float div = (float)133000000 / 800000.0 / 9.0;
+  bool ok = neopxl8_pio_config(&c, 133000000, &neopxl8_timing_800k) &&
+            (c.high == 2) && (c.data == 4) && (c.low == 3) && (c.div == div) &&
+            neopxl8_timing_rp2040(&w, 133000000, 300) &&
+            near(neopxl8_pio_clkdiv(c.div), 18.46875f) &&
+            near(w.t0h[0], 36000 / 133.0f) && near(w.t0h[1], 37000 / 133.0f) &&
+            near(w.t1h[0], 110000 / 133.0f) &&
+            near(w.t1h[1], 111000 / 133.0f) &&
+            near(w.period[0], 166000 / 133.0f) &&
+            near(w.period[1], 167000 / 133.0f) &&
+            near(w.t1l[0], 55000 / 133.0f) && // 3 cycles = 55.4 clocks
+            near(w.reset, 300 - 9 * 167 / 133.0f - 1) &&
+            !neopxl8_timing_check(&w, ws2812b);
+  printf("rp2040 133 MHz  %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // RP2040 at 120 MHz: divider is exactly 16.6667 -> 16 + 170/256, and
+  // T0H 2 cycles = 33.33 clocks, so 33-34 = 275-283.3 ns.
+  ok = neopxl8_timing_rp2040(&w, 120000000, 300) &&
+       neopxl8_pio_config(&c, 120000000, &neopxl8_timing_800k) &&
+       near(neopxl8_pio_clkdiv(c.div), 16 + 170 / 256.0f) &&
+       near(w.t0h[0], 275.0f) && near(w.t0h[1], 283.33f) &&
+       !neopxl8_timing_check(&w, ws2812b);
+  printf("rp2040 120 MHz  %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // SAMD: PER = 19, 20 clocks at 48 MHz per DMA beat = 416.7 ns, 3 beats
+  // per bit. Latch wait is shortened 30 us, 24 lead-in beats add 10 us.
+  ok = neopxl8_timing_samd(&w, 48000000, 300) &&
+       (neopxl8_tcc_period(48000000) == 19) && near(w.t0h[0], 416.67f) &&
+       near(w.t0h[1], 416.67f) && near(w.t1h[0], 833.33f) &&
+       near(w.t0l[1], 833.33f) && near(w.t1l[0], 416.67f) &&
+       near(w.period[0], 1250.0f) && near(w.reset, 279.0f) &&
+       !neopxl8_timing_check(&w, ws2812b);
+  printf("samd 48 MHz     %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // SAMD51 PORT DMA: at 48 MHz, T0H 278 ns = 13.3 -> 13 clocks, T1H 40,
+  // period 60. Writes at 1 ('1' lanes high), 1 + 40 - 13 = 28 (all high)
+  // and 41 (all low).
+  neopxl8_port_config_t pc;
+  ok = neopxl8_port_config(&pc, 48000000, &neopxl8_timing_800k) &&
+       (pc.per == 59) && (pc.cc[0] == 1) && (pc.cc[1] == 28) &&
+       (pc.cc[2] == 41) && neopxl8_timing_samd_port(&w, 48000000, 300) &&
+       near(w.t0h[0], 270.83f) && near(w.t1h[1], 833.33f) &&
+       near(w.t0l[0], 979.17f) && near(w.t1l[1], 416.67f) &&
+       near(w.period[0], 1250.0f) && near(w.reset, 299.0f) &&
+       !neopxl8_timing_check(&w, ws2812b);
+  // 400 KHz fits too; a period too short for both high times does not
+  neopxl8_timing_t fast = {278, 833, 800};
+  ok = ok &&
+       neopxl8_timing_samd_port(&w, 48000000, 300, &neopxl8_timing_400k) &&
+       !neopxl8_timing_check(&w, &neopxl8_chip_specs[4]) &&
+       !neopxl8_port_config(&pc, 48000000, &fast);
+  printf("samd51 port     %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // ESP32-S3: 240 MHz / (99 + 1/1) = 2.4 MHz, same beats as SAMD
+  uint16_t num;
+  uint8_t a, b;
+  neopxl8_lcd_divider(240000000, 1250, &num, &a, &b);
+  neopxl8_timing_esp32s3(&w, 240000000, 300);
+  ok = (num == 99) && (a == 1) && (b == 1) && near(w.t0h[0], 416.67f) &&
+       near(w.t1h[1], 833.33f) &&
+       near(w.period[1], 1250.0f) && near(w.reset, 299.0f) &&
+       !neopxl8_timing_check(&w, ws2812b);
+  printf("esp32s3         %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // 400 KHz: PIO 25 cycles per bit matches WS2811 exactly (5 + 7 + 13),
+  // SAMD and ESP32-S3 double their dividers. A fractional LCD divider:
+  // 1234 ns = 98.72 -> 98 + 45/63.
+  ok = neopxl8_pio_config(&c, 133000000, &neopxl8_timing_400k) &&
+       (c.high == 5) && (c.data == 7) && (c.low == 13) &&
+       near(c.div, 13.3f) && neopxl8_timing_rp2040(&w, 133000000, 300,
+                                                   &neopxl8_timing_400k) &&
+       !neopxl8_timing_check(&w, &neopxl8_chip_specs[4]) &&
+       (neopxl8_tcc_period(48000000, 2500) == 39);
+  neopxl8_lcd_divider(240000000, 2500, &num, &a, &b);
+  ok = ok && (num == 199) && (a == 1) && (b == 1);
+  neopxl8_lcd_divider(240000000, 1234, &num, &a, &b);
+  ok = ok && (num == 98) && (a == 63) && (b == 45);
+  // Impossible requests are refused
+  neopxl8_timing_t bad = {300, 200, 1250}; // T1H < T0H
+  ok = ok && !neopxl8_pio_config(&c, 133000000, &bad);
+  bad = {100, 200, 300}; // Period too short for 4 PIO cycles at 12 MHz
+  ok = ok && !neopxl8_pio_config(&c, 12000000, &bad);
+  bad = {100, 200, 0}; // Zero period
+  ok = ok && !neopxl8_tcc_config(48000000, &bad) &&
+       !neopxl8_timing_samd(&w, 48000000, 300, &bad);
+  bad = {10, 20, 30}; // Rounds to zero TCC clocks per beat
+  ok = ok && !neopxl8_tcc_config(48000000, &bad);
+  bad = {180, 360, 540}; // PER 8, faster than DMA is trusted to keep up
+  ok = ok && !neopxl8_tcc_config(48000000, &bad) &&
+       neopxl8_tcc_config(48000000, &neopxl8_timing_800k);
+  printf("timing config   %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  // Checks must catch out-of-range values: 800 KHz output can't meet
+  // 400 KHz WS2811 timing, and a too-fast PIO clock (as if F_CPU were
+  // misreported) or a short latch must fail even a forgiving chip.
+  neopxl8_timing_rp2040(&w, 133000000, 300);
+  uint8_t r = neopxl8_timing_check(&w, &neopxl8_chip_specs[4]);
+  ok = (r & NEOPXL8_TIMING_T1H) && (r & NEOPXL8_TIMING_T0L);
+  neopxl8_timing_bits(&w, 133000000, 100000000 / 800000.0 / 9.0, 2, 4, 3);
+  w.reset = 40;
+  r = neopxl8_timing_check(&w, ws2812b);
+  ok = ok && (r & NEOPXL8_TIMING_T0H) && (r & NEOPXL8_TIMING_T1H) &&
+       (r & NEOPXL8_TIMING_RESET) && !(r & NEOPXL8_TIMING_T0L);
+  printf("out of spec     %s\n", ok ? "OK" : "FAIL");
+  failures += !ok;
+
+  printf(failures ? "FAIL\n" : "PASS\n");
+  return failures ? 1 : 0;
+}
+
+// MAIN --------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  const char *platform = NULL;
+  const neopxl8_chip_spec_t *only = NULL;
+  uint32_t clock = 0;
+  int latch = 300;
+  neopxl8_timing_t timing = neopxl8_timing_800k;
+  bool test = false;
+
+  static const struct option opts[] = {
+      {"platform", required_argument, NULL, 'p'},
+      {"clock", required_argument, NULL, 'f'},
+      {"latch", required_argument, NULL, 'l'},
+      {"timing", required_argument, NULL, 't'},
+      {"chip", required_argument, NULL, 'c'},
+      {"selftest", no_argument, NULL, 's'},
+      {NULL, 0, NULL, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "p:f:l:t:c:s", opts, NULL)) != -1) {
+    switch (c) {
+    case 'p':
+      platform = optarg;
+      break;
+    case 'f':
+      clock = strtoul(optarg, NULL, 0);
+      break;
+    case 'l':
+      latch = atoi(optarg);
+      break;
+    case 't':
+      if (!strcasecmp(optarg, "400k")) {
+        timing = neopxl8_timing_400k;
+      } else if (strcasecmp(optarg, "800k")) {
+        unsigned t0h, t1h, period;
+        if (sscanf(optarg, "%u,%u,%u", &t0h, &t1h, &period) != 3)
+          usage(argv[0]);
+        timing = {(uint16_t)t0h, (uint16_t)t1h, (uint16_t)period};
+      }
+      break;
+    case 'c':
+      for (size_t i = 0; i < NEOPXL8_CHIP_SPECS; i++) {
+        if (!strcasecmp(optarg, neopxl8_chip_specs[i].name))
+          only = &neopxl8_chip_specs[i];
+      }
+      if (!only)
+        usage(argv[0]);
+      break;
+    case 's':
+      test = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if ((optind < argc) || (latch < 1) || (latch > 65535))
+    usage(argv[0]);
+  if (test)
+    return selftest();
+
+  int fails;
+  if (platform) {
+    if ((fails = run(platform, clock, latch, &timing, only)) < 0)
+      usage(argv[0]);
+  } else {
+    // Default and common overclocked settings for each platform
+    fails = run("rp2040", 133000000, latch, &timing, only) +
+            run("rp2350", 150000000, latch, &timing, only) +
+            run("rp2040", 200000000, latch, &timing, only) +
+            run("rp2040", 250000000, latch, &timing, only) +
+            run("samd21", 48000000, latch, &timing, only) +
+            run("samd51", 0, latch, &timing, only) +
+            run("samd51port", 0, latch, &timing, only) +
+            run("esp32s3", 0, latch, &timing, only);
+  }
+  return (only && fails) ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2017 P Burgess for Adafruit Industries
+//
+// SPDX-License-Identifier: MIT
+
+// neopxl8video: convert movie2msc .bin video (see extras/Processing) to
+// NeoPXL8 .npx format for Adafruit_NeoPXL8Player (see the VideoPlayer
+// example). Two formats are available: "planes" (default) applies layout,
+// color order, gamma and brightness here and pre-transposes the data, so
+// the microcontroller only copies it to the LEDs. "rgb" applies gamma and
+// brightness and compresses frames (keyframes plus changes from the prior
+// frame), which greatly reduces file size and flash reads for most video;
+// the microcontroller then handles layout and color order as it stages.
+// THIS IS A HOST COMPUTER PROGRAM, NOT ARDUINO CODE. Build with:
+//
+//   g++ -O2 -I../.. -o neopxl8video neopxl8video.cpp
+//
+// Run without arguments for usage. Width, height and layout settings must
+// match those in the board's neopxl8.cfg, as with the VideoMSC example.
+
+#include <Adafruit_NeoPXL8Video.h>
+#include <algorithm>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] input.bin output.npx\n"
+          "  -w, --width N        LED matrix width (default 30)\n"
+          "  -h, --height N       LED matrix height (default 16)\n"
+          "  -l, --layout N       0=progressive, 1=serpentine, +2=vertical\n"
+          "  -r, --rotate N       Image rotation, 0-3 (x 90 degrees)\n"
+          "  -t, --tiles AxD      Matrix is A tiles across, D tiles down\n"
+          "  -o, --order STR      LED color order, e.g. GRB (default), RGBW\n"
+          "                       (planes format only)\n"
+          "  -g, --gamma F        Gamma correction (default 2.6, 1 = off)\n"
+          "  -b, --brightness N   Brightness, 0-255 (default 255)\n"
+          "  -f, --format STR     planes (default) or rgb\n"
+          "  -k, --keyframe N     rgb format keyframe interval (default 100)\n"
+          "  -a, --align N        Payload file alignment (default 512 for\n"
+          "                       planes, 0 for rgb)\n",
+          prog);
+  exit(1);
+}
+
+// Same mapping as Adafruit_NeoPXL8::setLayout(): for each NeoPXL8 pixel
+// index, the source image pixel that appears there.
+static bool make_map(std::vector<uint32_t> &map, int width, int height,
+                     int layout, int rotation, int tilesAcross,
+                     int tilesDown) {
+  if (!tilesAcross || !tilesDown || (width % tilesAcross) ||
+      (height % tilesDown))
+    return false;
+  map.resize(width * height);
+  int tw = width / tilesAcross, th = height / tilesDown;
+  bool vertical = layout & 2, serpentine = layout & 1;
+  int lineLen = vertical ? th : tw;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      uint32_t src;
+      switch (rotation & 3) {
+      case 0:
+        src = y * width + x;
+        break;
+      case 1:
+        src = (width - 1 - x) * height + y;
+        break;
+      case 2:
+        src = (height - 1 - y) * width + (width - 1 - x);
+        break;
+      default:
+        src = x * height + (height - 1 - y);
+        break;
+      }
+      int lx = x % tw, ly = y % th;
+      int line = vertical ? lx : ly, pos = vertical ? ly : lx;
+      if (serpentine && (line & 1))
+        pos = lineLen - 1 - pos;
+      int tile = (y / th) * tilesAcross + (x / tw);
+      map[tile * tw * th + line * lineLen + pos] = src;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int width = 30, height = 16, layout = 0, rotation = 0;
+  int tilesAcross = 1, tilesDown = 1, brightness = 255, align = -1;
+  int keyframe = 100;
+  bool planes = true;
+  const char *order = "GRB";
+  double gamma = 2.6;
+
+  static const struct option opts[] = {
+      {"width", required_argument, NULL, 'w'},
+      {"height", required_argument, NULL, 'h'},
+      {"layout", required_argument, NULL, 'l'},
+      {"rotate", required_argument, NULL, 'r'},
+      {"tiles", required_argument, NULL, 't'},
+      {"order", required_argument, NULL, 'o'},
+      {"gamma", required_argument, NULL, 'g'},
+      {"brightness", required_argument, NULL, 'b'},
+      {"format", required_argument, NULL, 'f'},
+      {"keyframe", required_argument, NULL, 'k'},
+      {"align", required_argument, NULL, 'a'},
+      {NULL, 0, NULL, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "w:h:l:r:t:o:g:b:f:k:a:", opts, NULL)) !=
+         -1) {
+    switch (c) {
+    case 'w':
+      width = atoi(optarg);
+      break;
+    case 'h':
+      height = atoi(optarg);
+      break;
+    case 'l':
+      layout = atoi(optarg);
+      break;
+    case 'r':
+      rotation = atoi(optarg);
+      break;
+    case 't':
+      if (sscanf(optarg, "%dx%d", &tilesAcross, &tilesDown) != 2)
+        usage(argv[0]);
+      break;
+    case 'o':
+      order = optarg;
+      break;
+    case 'g':
+      gamma = atof(optarg);
+      break;
+    case 'b':
+      brightness = atoi(optarg);
+      break;
+    case 'f':
+      if (!strcmp(optarg, "rgb"))
+        planes = false;
+      else if (strcmp(optarg, "planes"))
+        usage(argv[0]);
+      break;
+    case 'k':
+      keyframe = atoi(optarg);
+      break;
+    case 'a':
+      align = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if ((argc - optind) != 2)
+    usage(argv[0]);
+
+  // NeoPXL8 requires pixel count to be a multiple of 8 (one per strand)
+  int numPixels = width * height;
+  if ((width < 1) || (height < 1) || (numPixels % 8) || (numPixels > 65535)) {
+    fprintf(stderr, "Pixel count must be a multiple of 8, max 65535\n");
+    return 1;
+  }
+  if (align < 0)
+    align = planes ? 512 : 0;
+  if (align > 65535) {
+    fprintf(stderr, "Invalid alignment\n");
+    return 1;
+  }
+  std::vector<uint32_t> map;
+  if (!make_map(map, width, height, layout, rotation, tilesAcross,
+                tilesDown)) {
+    fprintf(stderr, "Invalid tile arrangement\n");
+    return 1;
+  }
+
+  // For each output byte of a pixel, source RGB byte (or -1 for W = 0)
+  int bpp = strlen(order), chan[4];
+  if ((bpp < 3) || (bpp > 4)) {
+    fprintf(stderr, "Color order must be 3 or 4 letters\n");
+    return 1;
+  }
+  for (int i = 0; i < bpp; i++) {
+    const char *p = strchr("RGBW", order[i] & ~0x20);
+    if (!p || !order[i]) {
+      fprintf(stderr, "Unknown color order '%s'\n", order);
+      return 1;
+    }
+    chan[i] = (p[0] == 'W') ? -1 : (p - "RGBW");
+  }
+
+  // Gamma and brightness are merged into one table
+  uint8_t lut[256];
+  for (int i = 0; i < 256; i++) {
+    double v = (gamma > 0.0) ? pow(i / 255.0, gamma) : i / 255.0;
+    lut[i] = (int)(v * brightness + 0.5);
+  }
+
+  FILE *in = fopen(argv[optind], "rb");
+  if (!in) {
+    perror(argv[optind]);
+    return 1;
+  }
+  FILE *out = fopen(argv[optind + 1], "wb");
+  if (!out) {
+    perror(argv[optind + 1]);
+    return 1;
+  }
+
+  int strandLength = numPixels / 8;
+  neopxl8_video_header_t header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, NEOPXL8_VIDEO_MAGIC, 4);
+  header.version = NEOPXL8_VIDEO_VERSION;
+  header.layout = planes ? NEOPXL8_VIDEO_PLANES : NEOPXL8_VIDEO_RGB;
+  header.bytesPerPixel = planes ? bpp : 3;
+  header.lanes = 8;
+  header.strandLength = strandLength;
+  header.width = width;
+  header.height = height;
+  header.align = align;
+  header.frameBytes = planes ? strandLength * bpp * 8 : numPixels * 3;
+  header.matrixLayout = layout;
+  header.rotation = rotation;
+  header.tilesAcross = tilesAcross;
+  header.tilesDown = tilesDown;
+  fwrite(&header, sizeof header, 1, out); // Rewritten with totals at end
+
+  std::vector<uint8_t> image(numPixels * 3), frame(header.frameBytes);
+  std::vector<uint8_t> prev(numPixels * 3), zero(numPixels * 3);
+  std::vector<uint8_t> key(header.frameBytes), delta(header.frameBytes);
+  uint32_t pos = sizeof header;
+  uint64_t totalUsec = 0;
+  uint8_t rec[5];
+
+  while (fread(rec, 1, 5, in) == 5) {
+    uint32_t size = rec[1] | (rec[2] << 8), usec = rec[3] | (rec[4] << 8);
+    if (rec[0] == '%') { // Audio chunk, skip
+      fseek(in, size * 2, SEEK_CUR);
+      continue;
+    } else if (rec[0] != '*') {
+      fprintf(stderr, "Unknown record in input, stopping\n");
+      break;
+    }
+    // As in VideoMSC, excess pixels are ignored and missing ones are 0
+    std::fill(image.begin(), image.end(), 0);
+    uint32_t bytes = size * 3, n = std::min<uint32_t>(bytes, image.size());
+    if (fread(image.data(), 1, n, in) != n) {
+      fprintf(stderr, "Truncated frame in input, stopping\n");
+      break;
+    }
+    if (bytes > n)
+      fseek(in, bytes - n, SEEK_CUR);
+
+    neopxl8_video_frame_t f;
+    memset(&f, 0, sizeof f);
+    f.type = NEOPXL8_FRAME_RAW;
+    f.usec = usec;
+    f.size = header.frameBytes;
+    const uint8_t *payload = frame.data();
+
+    if (!planes) {
+      for (int i = 0; i < numPixels * 3; i++)
+        frame[i] = lut[image[i]];
+      // Use whichever of raw, key or delta frame is smallest. Deltas are
+      // not used at keyframe intervals, so playback can recover there.
+      uint32_t len = neopxl8_compress(frame.data(), zero.data(), numPixels,
+                                      key.data(), f.size - 1);
+      if (len) {
+        f.type = NEOPXL8_FRAME_KEY;
+        f.size = len;
+        payload = key.data();
+      }
+      if (header.frameCount && (!keyframe || (header.frameCount % keyframe)) &&
+          (len = neopxl8_compress(frame.data(), prev.data(), numPixels,
+                                  delta.data(), f.size - 1))) {
+        f.type = NEOPXL8_FRAME_DELTA;
+        f.size = len;
+        payload = delta.data();
+      }
+      prev = frame;
+    } else {
+      // Transpose: byte of each NeoPixel bit holds bit for all strands
+      std::fill(frame.begin(), frame.end(), 0);
+      for (int s = 0; s < 8; s++) {
+        uint8_t *dst = frame.data();
+        for (int p = 0; p < strandLength; p++) {
+          const uint8_t *rgb = &image[map[s * strandLength + p] * 3];
+          for (int i = 0; i < bpp; i++) {
+            uint8_t v = (chan[i] >= 0) ? lut[rgb[chan[i]]] : 0;
+            for (uint8_t bit = 0x80; bit; bit >>= 1) {
+              if (v & bit)
+                *dst |= 1 << s;
+              dst++;
+            }
+          }
+        }
+      }
+    }
+
+    uint32_t recPos = neopxl8_video_record_pos(pos, align);
+    for (; pos < recPos; pos++)
+      fputc(0, out);
+    fwrite(&f, sizeof f, 1, out);
+    fwrite(payload, 1, f.size, out);
+    pos += sizeof f + f.size;
+    header.frameCount++;
+    totalUsec += usec;
+  }
+
+  if (header.frameCount)
+    header.frameUsec = totalUsec / header.frameCount;
+  fseek(out, 0, SEEK_SET);
+  fwrite(&header, sizeof header, 1, out);
+  fclose(in);
+  if (fclose(out)) {
+    perror(argv[optind + 1]);
+    return 1;
+  }
+  printf("%u frames of %u bytes, file size %u\n",
+         (unsigned)header.frameCount, (unsigned)header.frameBytes,
+         (unsigned)pos);
+  return 0;
+}